@@ -1,25 +1,70 @@
 @echo off
 REM Build script for Telemetry Generator
 REM Requires Visual Studio or Windows SDK with cl.exe in PATH
+REM
+REM Builds the general binary plus one specialized binary per scenario.
+REM The specialized binaries bake their generator mix and defaults in at
+REM compile time (/DTG_SCENARIO_*), removing per-event dispatch from the
+REM hot path for the tightest-loop tests. Pass a scenario name to build
+REM just that one: build.bat fire
 
-echo Building Telemetry Generator...
+setlocal
+set CFLAGS=/nologo /W3 /O2
+set LIBS=ws2_32.lib advapi32.lib
+
+if "%1"=="" goto build_all
+if /I "%1"=="general" goto build_general
+if /I "%1"=="fire" goto build_fire
+if /I "%1"=="dns" goto build_dns
+if /I "%1"=="reg" goto build_reg
+if /I "%1"=="net" goto build_net
+echo Unknown scenario "%1" (general, fire, dns, reg, net)
+exit /b 1
+
+:build_all
+echo Building Telemetry Generator matrix...
 echo.
+call :compile telemetry_generator.exe ""
+call :compile telemetry_fire.exe /DTG_SCENARIO_FIRE
+call :compile telemetry_dns.exe /DTG_SCENARIO_DNS
+call :compile telemetry_reg.exe /DTG_SCENARIO_REG
+call :compile telemetry_net.exe /DTG_SCENARIO_NET
+goto done
+
+:build_general
+call :compile telemetry_generator.exe ""
+goto done
+
+:build_fire
+call :compile telemetry_fire.exe /DTG_SCENARIO_FIRE
+goto done
+
+:build_dns
+call :compile telemetry_dns.exe /DTG_SCENARIO_DNS
+goto done
 
-REM Compile the program
-cl.exe /nologo /W3 /O2 /Fe:telemetry_generator.exe telemetry_generator.c /link ws2_32.lib wininet.lib advapi32.lib
+:build_reg
+call :compile telemetry_reg.exe /DTG_SCENARIO_REG
+goto done
 
+:build_net
+call :compile telemetry_net.exe /DTG_SCENARIO_NET
+goto done
+
+:compile
+cl.exe %CFLAGS% %~2 /Fe:%~1 telemetry_generator.c /link %LIBS%
 if %ERRORLEVEL% EQU 0 (
-    echo.
-    echo [+] Build successful!
-    echo [+] Output: telemetry_generator.exe
-    echo.
-    echo To run: telemetry_generator.exe
+    echo [+] Built %~1
 ) else (
-    echo.
-    echo [-] Build failed!
+    echo [-] Build failed for %~1
     echo.
     echo Make sure you have Visual Studio installed and run this from:
     echo "Developer Command Prompt for VS" or "x64 Native Tools Command Prompt"
+    exit /b 1
 )
+exit /b 0
 
+:done
+echo.
+echo [+] Build complete.
 pause
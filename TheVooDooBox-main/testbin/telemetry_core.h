@@ -0,0 +1,205 @@
+/*
+ * Telemetry Generator - shared engine core
+ *
+ * The pieces of the generator that are pure computation - the PRNG,
+ * the latency histogram math, the generator-mix flags and the phase
+ * profile parser - live here so the Windows binary and the Linux
+ * binary (telemetry_generator_linux.c, for the Voodoo Gateway /
+ * Remnux side) are driven by literally the same code. Same seed, same
+ * domain sequence; same bucket math, same percentiles; same profile
+ * spec, same phases. That is what makes the numbers from the two
+ * sandboxes comparable instead of merely similar.
+ *
+ * Everything in this header is platform-free C: no Win32, no POSIX,
+ * no atomics, no clocks. Each platform file supplies its own time
+ * source, thread-local RNG registration, atomic counters and sleep,
+ * and calls into these routines from its hot paths.
+ */
+
+#ifndef TELEMETRY_CORE_H
+#define TELEMETRY_CORE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+// Deterministic PRNG: splitmix64 seeding, xoshiro256** streams
+// ---------------------------------------------------------------------------
+
+static unsigned long long SplitMix64(unsigned long long* x) {
+    unsigned long long z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static unsigned long long RotL64(unsigned long long x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// One xoshiro256** step; the caller owns the 4-word state and derives
+// it from the run seed via SplitMix64, keyed by stream index
+static unsigned long long XoshiroNext(unsigned long long s[4]) {
+    unsigned long long result = RotL64(s[1] * 5, 7) * 9;
+    unsigned long long t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotL64(s[3], 45);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Emission-latency histogram: log2 major buckets, 8 linear sub-buckets
+// ---------------------------------------------------------------------------
+
+enum LatClass {
+    LAT_REGISTRY = 0,
+    LAT_FILE,
+    LAT_NETWORK,
+    LAT_DNS,
+    LAT_MUTEX,
+    LAT_MODULE,
+    LAT_CLASS_COUNT
+};
+
+#define LAT_BUCKETS 320 // (40 major) * (8 sub), covers ~18 minutes in ns
+
+static const char* const g_latClassNames[LAT_CLASS_COUNT] = {
+    "registry", "file", "network", "dns", "mutex", "module"
+};
+
+static int LatBucketIndex(unsigned long long ns) {
+    int major = 0;
+    unsigned long long v = ns;
+
+    if (ns < 8) {
+        return (int)ns;
+    }
+    while (v >>= 1) major++;
+    int sub = (int)((ns >> (major - 3)) & 7);
+    int idx = (major - 2) * 8 + sub;
+    return idx < LAT_BUCKETS ? idx : LAT_BUCKETS - 1;
+}
+
+// Representative (midpoint-ish) nanosecond value for a bucket index
+static unsigned long long LatBucketValue(int idx) {
+    if (idx < 8) {
+        return (unsigned long long)idx;
+    }
+    int major = idx / 8 + 2;
+    int sub = idx % 8;
+    return ((unsigned long long)(8 + sub)) << (major - 3);
+}
+
+// ---------------------------------------------------------------------------
+// Generator mix flags and phase profiles
+// ---------------------------------------------------------------------------
+
+#define MIX_MUTEX    0x01
+#define MIX_REGISTRY 0x02
+#define MIX_WEB      0x04
+#define MIX_FILES    0x08
+#define MIX_DNS      0x10
+#define MIX_SPAWN    0x20
+#define MIX_MODULE   0x40
+#define MIX_ALL      0x7F
+
+#define PROFILE_MAX_PHASES 16
+#define PROFILE_STEP_MS 100    // scheduler tick / ramp resolution
+#define BURST_HALF_PERIOD_MS 500
+
+typedef enum PhaseKind {
+    PHASE_STEADY,
+    PHASE_RAMP,
+    PHASE_BURST
+} PhaseKind;
+
+typedef struct ProfilePhase {
+    PhaseKind kind;
+    int durationSec;
+    int rate;          // events/sec at (or ramping to) the target
+    long mix;          // MIX_* mask of live generators
+    char name[16];
+} ProfilePhase;
+
+// Parse "KIND:SECS:RATE[:MIX]" phases from a comma-separated spec, e.g.
+// "ramp:30:5000,burst:60:8000,steady:300:2000:rd". MIX letters map to
+// m/r/w/f/d/p/l; omitted means all generators. Returns the phase
+// count, 0 on a bad spec.
+static int ParseProfileSpec(const char* spec, ProfilePhase* phases, int maxPhases) {
+    char buf[512];
+    int count = 0;
+
+    strncpy(buf, spec, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    char* phase = strtok(buf, ",");
+    while (phase != NULL) {
+        if (count >= maxPhases) {
+            printf("[-] Profile: more than %d phases\n", maxPhases);
+            return 0;
+        }
+        ProfilePhase* p = &phases[count];
+
+        char* kind = phase;
+        char* secs = strchr(kind, ':');
+        if (secs == NULL) return 0;
+        *secs++ = '\0';
+        char* rate = strchr(secs, ':');
+        if (rate == NULL) return 0;
+        *rate++ = '\0';
+        char* mix = strchr(rate, ':');
+        if (mix != NULL) *mix++ = '\0';
+
+        if (strcmp(kind, "steady") == 0)     p->kind = PHASE_STEADY;
+        else if (strcmp(kind, "ramp") == 0)  p->kind = PHASE_RAMP;
+        else if (strcmp(kind, "burst") == 0) p->kind = PHASE_BURST;
+        else {
+            printf("[-] Profile: unknown phase kind '%s'\n", kind);
+            return 0;
+        }
+        memset(p->name, 0, sizeof(p->name));
+        strncpy(p->name, kind, sizeof(p->name) - 1);
+
+        p->durationSec = atoi(secs);
+        p->rate = atoi(rate);
+        if (p->durationSec <= 0 || p->rate <= 0) {
+            printf("[-] Profile: bad duration/rate in phase '%s'\n", kind);
+            return 0;
+        }
+
+        p->mix = 0;
+        if (mix == NULL || *mix == '\0') {
+            p->mix = MIX_ALL;
+        } else {
+            for (; *mix; mix++) {
+                switch (*mix) {
+                    case 'm': p->mix |= MIX_MUTEX;    break;
+                    case 'r': p->mix |= MIX_REGISTRY; break;
+                    case 'w': p->mix |= MIX_WEB;      break;
+                    case 'f': p->mix |= MIX_FILES;    break;
+                    case 'd': p->mix |= MIX_DNS;      break;
+                    case 'p': p->mix |= MIX_SPAWN;    break;
+                    case 'l': p->mix |= MIX_MODULE;   break;
+                    default:
+                        printf("[-] Profile: unknown mix letter '%c'\n", *mix);
+                        return 0;
+                }
+            }
+        }
+
+        count++;
+        phase = strtok(NULL, ",");
+    }
+    return count;
+}
+
+// Run reports from both platforms share this schema version; bump it
+// whenever a metric line is added, renamed or rescaled
+#define TG_REPORT_SCHEMA 1
+
+#endif // TELEMETRY_CORE_H
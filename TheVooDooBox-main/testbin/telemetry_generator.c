@@ -1,12 +1,16 @@
 /*
  * Telemetry Generator - Test Binary for Malware Lab Sensor
- * 
+ *
  * This program generates various telemetry events including:
  * - Registry modifications (RunOnce, Startup)
  * - Network connections (simulated C2 traffic)
  * - File operations
  * - Process creation
  * - DNS queries
+ *
+ * Events are driven by a pool of worker threads so a single instance
+ * can act as a load generator for the agent's ingestion path, not just
+ * a smoke test. See PrintUsage() for the command line options.
  */
 
 #define WINVER 0x0601
@@ -15,15 +19,92 @@
 #include <windows.h>
 #include <winsock2.h>
 #include <ws2tcpip.h>
-#include <wininet.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <emmintrin.h> // SSE2 payload fill; baseline on every x64 target
+#include <evntprov.h>
 #include <time.h>
 #include <string.h>
 
-#pragma comment(lib, "wininet.lib")
+#include "telemetry_core.h" // engine core shared with the Linux binary
+
 #pragma comment(lib, "advapi32.lib")
 #pragma comment(lib, "ws2_32.lib")
 
+// Run configuration, filled in from the command line in main()
+typedef struct GeneratorConfig {
+    int threads;      // worker thread count (0 = one per logical CPU)
+    int durationSec;  // run length in seconds (0 = fixed number of passes)
+    int loops;        // passes per worker when durationSec == 0
+    int wait;         // wait for a keypress before exiting
+    int beacons;      // HTTP beacons per worker pass
+    int httpPool;     // pooled keep-alive connections per worker
+    int dnsQueries;   // DNS queries per worker pass
+    int dnsInflight;  // concurrent in-flight DNS queries per worker
+    int dnsDga;       // generate DGA-style random domains instead of the fixed list
+    const char* dnsServer; // resolver the UDP engine sends to
+    int eps;          // target aggregate events/sec (0 = unpaced legacy timing)
+    int regOps;       // registry churn operations per worker pass
+    int regFanout;    // churn subkeys under Software\\TelemetryTest
+    int fileOps;      // file create/write/delete cycles per worker pass
+    int fileDirs;     // temp subdirectories the file churn spreads across
+    int spawnDepth;   // process tree depth per pass (0 = phase disabled)
+    int spawnWidth;   // children per tree node
+    unsigned int seed;     // PRNG seed (0 = derive from wall clock)
+    const char* tracePath; // binary event trace output (NULL = off)
+    int quiet;        // drop all hot-path logging
+    const char* firehosePath; // agent channel for framed direct emission
+    int fireEvents;   // frames to emit in firehose mode
+    const char* profile;   // phase profile spec (see ParseProfile)
+    int objOps;       // named-object create/close ops per worker pass
+    int objBatch;     // handles held open before a batched close
+    int soakHours;    // long-run soak mode with pipelined self-cleanup
+    int swarm;        // worker-process copies to launch (parent role)
+    int swarmWorker;  // our slot index when running as a swarm child
+    DWORD swarmKey;   // parent pid, names the shared segment and event
+    const char* targetsPath;  // memory-mapped target-list file
+    int xferOps;      // large HTTP transfers per worker pass (0 = off)
+    const char* xferServer;   // local echo server, host:port
+    int xferMinKb;    // transfer size distribution, lower bound
+    int xferMaxKb;    // transfer size distribution, upper bound
+    int bench;        // micro-benchmark the generator functions and exit
+    int connOps;      // ephemeral TCP connect/close cycles per worker pass
+    const char* connServer;   // churn targets, comma-separated host:port
+    int seqTable;     // tag artifacts with sequence IDs, publish timestamps
+    int findMax;      // closed-loop search for max sustainable events/sec
+    int payloadKb;    // churn-file payload size
+    int payloadEntropy; // percent of payload blocks that are random
+    int dllOps;       // module load/free cycles per worker pass
+    int dllStubs;     // generated stub DLLs mixed into the rotation
+    int fastStart;    // skip console/banner, init from the warm cache
+    int affinity;     // pin workers to cores by topology
+    int reserveCores; // leading physical cores left free for the sensor
+    const char* reportPath;   // write the machine-readable run report here
+    int dnsFast;      // pre-serialized packet ring instead of per-query encode
+    int etwEvents;    // ETW provider mode: events to write (0 = off)
+} GeneratorConfig;
+
+GeneratorConfig g_config = { 0, 0, 1, 0, 5, 4, 5, 16, 0, "8.8.8.8", 0, 16, 4, 8, 4, 0, 2,
+                             0, NULL, 0, NULL, 100000, NULL, 16, 64, 0, 0, -1, 0,
+                             NULL, 0, "127.0.0.1:8080", 4, 1024, 0, 0,
+                             "127.0.0.1:9", 0, 0, 4, 100, 0, 4, 0, 0, 0, NULL, 0, 0 };
+
+// MSVC and MinGW spell thread-local storage differently
+#ifdef _MSC_VER
+#define TG_THREAD_LOCAL __declspec(thread)
+#else
+#define TG_THREAD_LOCAL __thread
+#endif
+
+// Set to 1 to ask all workers to wind down
+volatile LONG g_stop = 0;
+
+// Total telemetry-generating operations performed across all workers.
+// 64-bit: a soak run at the rates this tool targets wraps a LONG.
+volatile LONGLONG g_eventsEmitted = 0;
+
 // Function prototypes
 void CreateRegistryEntries();
 void MakeWebRequests();
@@ -31,251 +112,4358 @@ void CreateFiles();
 void PerformDNSLookups();
 void ModifySystemTime();
 void CreateTestMutex();
+void RunObjectEngine(int ops);
+void ObjectEngineFlush();
+void CleanupEnqueue(const char* path);
+void CleanupStart();
+void CleanupStop();
+int RunSwarmParent(int argc, char* argv[]);
+void SwarmChildArrive();
+void SwarmChildReport();
+int TargetsBuild(const char* inPath, const char* outPath);
+int TargetsLoad(const char* path);
+const char* TargetName(ULONG idx);
+int InitXferEngine();
+void RunTransferEngine(int transfers);
+int RunBench();
+int InitConnEngine();
+void RunConnEngine(int cycles);
+int SeqTableInit();
+LONG SeqClaim();
+void SeqStamp(LONG tag);
+void RunAdaptiveController();
+void PayloadFill(char* buf, size_t bytes, ULONGLONG seed, int entropyPct);
+void InitDllEngine(int stubs);
+void RunDllEngine(int ops);
+void CloseDllEngine();
+int FastStartLoad();
+void FastStartSave();
+int InitCpuTopology();
+void PinWorkerThread(int workerId);
+void WriteRunReport(const char* path, ULONGLONG elapsedMs);
+int ReportCompare(const char* oldPath, const char* newPath);
+int InitDnsFastPath();
 void SleepRandom();
+void CountEvent();
+DWORD WINAPI GeneratorWorker(LPVOID param);
+void PrintUsage(const char* exeName);
+int InitBeaconTargets();
+void RunBeaconEngine(int totalRequests, int poolSize);
+void RunDnsEngine(int totalQueries, int maxInflight);
+void RateInit(int eps);
+void RateWaitToken();
+void RateSetEps(double eps);
+void RatePause(int paused);
+int ParseProfile(const char* spec);
+void RunProfileScheduler();
+void InitRegistryEngine(int fanout);
+void CloseRegistryEngine();
+void RunRegistryEngine(int ops);
+void InitFileEngine(int dirs);
+void CloseFileEngine();
+void RunFileEngine(int ops);
+void SpawnProcessTree(int depth, int width);
+int TreeNodeMain(int depth, int width);
+unsigned int TgRand(unsigned int bound);
+void TraceInit(const char* path);
+void TraceClose();
+void TgLog(const char* fmt, ...);
+void LogInit();
+void LogShutdown();
+void RunFirehose();
+void RunEtwMode();
+ULONGLONG LatNow();
+void LatRecord(int latClass, ULONGLONG startQpc);
+void PrintLatencyReport();
 
-int main(int argc, char* argv[]) {
-    // Ensure we have a console window
-    if (!GetConsoleWindow()) {
-        AllocConsole();
-        freopen("CONOUT$", "w", stdout);
-        freopen("CONOUT$", "w", stderr);
+// ---------------------------------------------------------------------------
+// Deterministic PRNG and event trace
+//
+// srand(time(NULL)) made every run unique, so two agent builds could
+// never be compared on identical input. All randomness (pass timing,
+// DGA domains, payload bytes) now comes from xoshiro256** streams: each
+// worker thread gets its own state derived from the --seed value via
+// splitmix64, keyed by thread registration order so a fixed seed
+// reproduces the same sequences run to run. With --trace FILE, every
+// emitted event is appended to a compact binary trace of
+// (QPC timestamp, sequence) records for offline diffing of two runs.
+// ---------------------------------------------------------------------------
+
+typedef struct TgRng {
+    ULONGLONG s[4];
+} TgRng;
+
+ULONGLONG g_rngSeed = 0;
+volatile LONG g_rngStreams = 0;
+TG_THREAD_LOCAL TgRng t_rng;
+TG_THREAD_LOCAL int t_rngReady = 0;
+
+// xoshiro256**: one independent stream per calling thread; the step
+// itself lives in telemetry_core.h, shared with the Linux binary
+static ULONGLONG TgRand64() {
+    if (!t_rngReady) {
+        // Stream index comes from registration order, not the thread id,
+        // so a fixed seed gives the same streams on every run
+        ULONGLONG stream = g_rngSeed +
+                           0x632BE59BD9B4E019ULL * (ULONGLONG)InterlockedIncrement(&g_rngStreams);
+        for (int i = 0; i < 4; i++) {
+            t_rng.s[i] = SplitMix64(&stream);
+        }
+        t_rngReady = 1;
     }
+    return XoshiroNext(t_rng.s);
+}
 
-    // Set unbuffered output for real-time streaming to screen
-    setvbuf(stdout, NULL, _IONBF, 0);
+// Uniform value in [0, bound)
+unsigned int TgRand(unsigned int bound) {
+    return (unsigned int)(TgRand64() % bound);
+}
 
-    printf("====================================================\n");
-    printf("        MALWARE LAB TELEMETRY GENERATOR             \n");
-    printf("====================================================\n");
-    printf("[*] Starting telemetry generation stream...\n\n");
+// ---------------------------------------------------------------------------
+// Emission-latency instrumentation
+//
+// Every hot operation (registry set/delete, file create and write
+// completion, TCP connect, DNS round trip, mutex create) is timed with
+// QueryPerformanceCounter and recorded into an HDR-style histogram:
+// log2 major buckets with 8 linear sub-buckets each, so the full range
+// from sub-microsecond to seconds fits in a small fixed array with
+// bounded relative error. Recording is one InterlockedIncrement, cheap
+// enough to leave on for every load run. PrintLatencyReport() dumps
+// p50/p90/p99/p999 per class at exit - the numbers that tell us whether
+// a stall happened in the generator or in the agent.
+// ---------------------------------------------------------------------------
 
-    // Initialize Winsock
-    WSADATA wsaData;
-    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-        printf("[-] WSAStartup failed\n");
-        return 1;
+// ---------------------------------------------------------------------------
+// Lock-free log ring
+//
+// With unbuffered stdout, every printf serialized all workers behind
+// console I/O - fatal once the engines run concurrently. Hot-path
+// logging now goes through TgLog(): producers claim a slot in a
+// fixed-size MPSC ring with a compare-exchange, format into it, and
+// mark it ready; a dedicated writer thread drains ready slots into
+// large batched WriteFile calls. When the ring is full the message is
+// dropped (and counted) rather than ever blocking a worker. --quiet
+// skips formatting entirely. The [STREAM] narration stays available
+// for demos without ever becoming the bottleneck of a load run.
+// ---------------------------------------------------------------------------
+
+#define LOG_RING 1024   // must be a power of two
+#define LOG_MSG_MAX 224
+#define LOG_BATCH 8192
+
+typedef struct LogSlot {
+    volatile LONG ready;
+    int len;
+    char text[LOG_MSG_MAX];
+} LogSlot;
+
+LogSlot g_logRing[LOG_RING];
+volatile LONG g_logHead = 0;    // next slot producers will claim
+volatile LONG g_logTail = 0;    // writer progress, read by producers
+volatile LONG g_logDropped = 0; // messages lost to a full ring
+volatile LONG g_logStop = 0;
+HANDLE g_logThread = NULL;
+int g_logActive = 0;
+
+void TgLog(const char* fmt, ...) {
+    va_list args;
+
+    if (g_config.quiet) {
+        return;
+    }
+
+    // Before the writer thread exists (startup) or after it is gone
+    // (final report), fall back to plain printf
+    if (!g_logActive) {
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+        return;
+    }
+
+    for (;;) {
+        LONG head = g_logHead;
+        if (head - g_logTail >= LOG_RING) {
+            InterlockedIncrement(&g_logDropped);
+            return; // never block a worker on console I/O
+        }
+        if (InterlockedCompareExchange(&g_logHead, head + 1, head) == head) {
+            LogSlot* slot = &g_logRing[head & (LOG_RING - 1)];
+            va_start(args, fmt);
+            int len = vsnprintf(slot->text, LOG_MSG_MAX, fmt, args);
+            va_end(args);
+            if (len < 0) len = 0;
+            if (len >= LOG_MSG_MAX) len = LOG_MSG_MAX - 1;
+            slot->len = len;
+            InterlockedExchange(&slot->ready, 1); // publish
+            return;
+        }
     }
+}
 
-    // Initialize random seed
-    srand((unsigned int)time(NULL));
+DWORD WINAPI LogWriterThread(LPVOID param) {
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    char batch[LOG_BATCH];
+    int batchLen = 0;
+    DWORD written;
 
-    // Create mutex (common malware behavior)
-    printf("[STREAM] Creating process mutex...\n");
-    CreateTestMutex();
-    SleepRandom();
+    for (;;) {
+        LogSlot* slot = &g_logRing[g_logTail & (LOG_RING - 1)];
 
-    // Create registry persistence entries
-    printf("[STREAM] Modifying registry keys for persistence...\n");
-    CreateRegistryEntries();
-    SleepRandom();
+        if (g_logTail < g_logHead && slot->ready) {
+            if (batchLen + slot->len > LOG_BATCH) {
+                WriteFile(console, batch, (DWORD)batchLen, &written, NULL);
+                batchLen = 0;
+            }
+            memcpy(batch + batchLen, slot->text, slot->len);
+            batchLen += slot->len;
+            slot->len = 0;
+            InterlockedExchange(&slot->ready, 0);
+            InterlockedIncrement(&g_logTail);
+        } else {
+            // Ring empty: flush what we have, then idle briefly
+            if (batchLen > 0) {
+                WriteFile(console, batch, (DWORD)batchLen, &written, NULL);
+                batchLen = 0;
+            }
+            if (g_logStop && g_logTail >= g_logHead) {
+                break;
+            }
+            Sleep(1);
+        }
+    }
 
-    // Make web requests (simulated C2 traffic)
-    printf("[STREAM] Initiating C2 network beaconing...\n");
-    MakeWebRequests();
-    SleepRandom();
+    (void)param;
+    return 0;
+}
 
-    // Create suspicious files
-    printf("[STREAM] dropper.exe simulation: creating files...\n");
-    CreateFiles();
-    SleepRandom();
+void LogInit() {
+    g_logStop = 0;
+    g_logThread = CreateThread(NULL, 0, LogWriterThread, NULL, 0, NULL);
+    if (g_logThread != NULL) {
+        g_logActive = 1;
+    }
+}
 
-    // Perform DNS lookups
-    printf("[STREAM] Performing DNS enumeration...\n");
-    PerformDNSLookups();
-    SleepRandom();
+void LogShutdown() {
+    if (g_logThread != NULL) {
+        InterlockedExchange(&g_logStop, 1);
+        WaitForSingleObject(g_logThread, 2000);
+        CloseHandle(g_logThread);
+        g_logThread = NULL;
+    }
+    g_logActive = 0;
+    if (g_logDropped > 0) {
+        printf("[!] Log ring dropped %ld messages under load\n", g_logDropped);
+    }
+}
 
-    printf("\n[+] Telemetry generation complete!\n");
-    printf("[*] Press any key to exit...\n");
-    getchar();
+LARGE_INTEGER g_perfFreq; // filled in by RateInit(), used by all timing code
 
-    WSACleanup();
+// Class enum, names and the bucket math live in telemetry_core.h
+volatile LONG g_latHist[LAT_CLASS_COUNT][LAT_BUCKETS];
+volatile LONG g_latSamples[LAT_CLASS_COUNT];
+
+ULONGLONG LatNow() {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (ULONGLONG)now.QuadPart;
+}
+
+// Record the elapsed time since startQpc under the given class
+void LatRecord(int latClass, ULONGLONG startQpc) {
+    ULONGLONG ns = (LatNow() - startQpc) * 1000000000ULL /
+                   (ULONGLONG)g_perfFreq.QuadPart;
+    InterlockedIncrement(&g_latHist[latClass][LatBucketIndex(ns)]);
+    InterlockedIncrement(&g_latSamples[latClass]);
+}
+
+static ULONGLONG LatPercentile(int latClass, double fraction) {
+    LONG total = g_latSamples[latClass];
+    LONG target = (LONG)(total * fraction);
+    LONG seen = 0;
+
+    for (int i = 0; i < LAT_BUCKETS; i++) {
+        seen += g_latHist[latClass][i];
+        if (seen >= target) {
+            return LatBucketValue(i);
+        }
+    }
+    return LatBucketValue(LAT_BUCKETS - 1);
+}
+
+void PrintLatencyReport() {
+    printf("\n[*] Per-operation latency (usec):\n");
+    printf("    %-10s %10s %10s %10s %10s %10s\n",
+           "class", "samples", "p50", "p90", "p99", "p999");
+    for (int latClass = 0; latClass < LAT_CLASS_COUNT; latClass++) {
+        if (g_latSamples[latClass] == 0) {
+            continue;
+        }
+        printf("    %-10s %10ld %10.1f %10.1f %10.1f %10.1f\n",
+               g_latClassNames[latClass], g_latSamples[latClass],
+               LatPercentile(latClass, 0.50) / 1000.0,
+               LatPercentile(latClass, 0.90) / 1000.0,
+               LatPercentile(latClass, 0.99) / 1000.0,
+               LatPercentile(latClass, 0.999) / 1000.0);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Run reports and regression comparison
+//
+// The human summary above gets screen-scraped into spreadsheets, which
+// is how regressions slip through. --report writes the same numbers as
+// flat metric,value CSV lines (counts, achieved rate, latency
+// percentile summaries per class) and --compare diffs two such files:
+// any rate drop or latency increase beyond the threshold is flagged and
+// the exit code goes to 2, which is all CI needs to fail the build on a
+// 10% agent-overhead regression.
+// ---------------------------------------------------------------------------
+
+#define REPORT_MAX_METRICS 96
+#define REPORT_THRESHOLD_PCT 10.0
+
+void WriteRunReport(const char* path, ULONGLONG elapsedMs) {
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        printf("[-] Report: cannot write %s\n", path);
+        return;
+    }
+    if (elapsedMs == 0) elapsedMs = 1;
+
+    fprintf(f, "schema,%d\n", TG_REPORT_SCHEMA);
+    fprintf(f, "events,%lld\n", (long long)g_eventsEmitted);
+    fprintf(f, "elapsed_ms,%llu\n", (unsigned long long)elapsedMs);
+    fprintf(f, "eps,%.1f\n", g_eventsEmitted * 1000.0 / elapsedMs);
+    fprintf(f, "log_dropped,%ld\n", g_logDropped);
+
+    for (int latClass = 0; latClass < LAT_CLASS_COUNT; latClass++) {
+        if (g_latSamples[latClass] == 0) {
+            continue;
+        }
+        const char* name = g_latClassNames[latClass];
+        fprintf(f, "lat_%s_samples,%ld\n", name, g_latSamples[latClass]);
+        fprintf(f, "lat_%s_p50_us,%.1f\n", name,
+                LatPercentile(latClass, 0.50) / 1000.0);
+        fprintf(f, "lat_%s_p90_us,%.1f\n", name,
+                LatPercentile(latClass, 0.90) / 1000.0);
+        fprintf(f, "lat_%s_p99_us,%.1f\n", name,
+                LatPercentile(latClass, 0.99) / 1000.0);
+    }
+
+    fclose(f);
+    printf("[*] Report written: %s\n", path);
+}
+
+typedef struct ReportMetric {
+    char name[48];
+    double value;
+} ReportMetric;
+
+static int ReportLoad(const char* path, ReportMetric* metrics) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        printf("[-] Compare: cannot open %s\n", path);
+        return -1;
+    }
+
+    char line[128];
+    int count = 0;
+    while (fgets(line, sizeof(line), f) != NULL &&
+           count < REPORT_MAX_METRICS) {
+        char* comma = strchr(line, ',');
+        if (comma == NULL) {
+            continue;
+        }
+        *comma = '\0';
+        strncpy(metrics[count].name, line, sizeof(metrics[count].name) - 1);
+        metrics[count].name[sizeof(metrics[count].name) - 1] = '\0';
+        metrics[count].value = atof(comma + 1);
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+// Higher is worse for latency and drop metrics; lower is worse for
+// throughput. Everything else is informational.
+static int ReportIsRegression(const char* name, double delta) {
+    if (strstr(name, "_p") != NULL || strstr(name, "dropped") != NULL) {
+        return delta > REPORT_THRESHOLD_PCT;
+    }
+    if (strcmp(name, "eps") == 0 || strcmp(name, "events") == 0 ||
+        strstr(name, "_samples") != NULL) {
+        return delta < -REPORT_THRESHOLD_PCT;
+    }
     return 0;
 }
 
-void CreateRegistryEntries() {
-    HKEY hKey;
-    LONG result;
-    char exePath[MAX_PATH];
-    
-    // Get current executable path
-    GetModuleFileNameA(NULL, exePath, MAX_PATH);
+// Exit code 0 when clean, 2 when any metric regressed past the
+// threshold - the shape CI gates want.
+int ReportCompare(const char* oldPath, const char* newPath) {
+    ReportMetric oldM[REPORT_MAX_METRICS], newM[REPORT_MAX_METRICS];
+    int oldCount = ReportLoad(oldPath, oldM);
+    int newCount = ReportLoad(newPath, newM);
+    int regressions = 0;
 
-    // Create RunOnce entry
-    result = RegOpenKeyExA(HKEY_CURRENT_USER, 
-                          "Software\\Microsoft\\Windows\\CurrentVersion\\RunOnce", 
-                          0, KEY_WRITE, &hKey);
-    
-    if (result == ERROR_SUCCESS) {
-        RegSetValueExA(hKey, "TelemetryTest", 0, REG_SZ, 
-                      (BYTE*)exePath, (DWORD)strlen(exePath) + 1);
-        printf("  [+] Created RunOnce registry entry\n");
-        RegCloseKey(hKey);
-    } else {
-        printf("  [-] Failed to create RunOnce entry (Error: %ld)\n", result);
+    if (oldCount < 0 || newCount < 0) {
+        return 1;
     }
 
-    // Create Run entry (Startup)
-    result = RegOpenKeyExA(HKEY_CURRENT_USER, 
-                          "Software\\Microsoft\\Windows\\CurrentVersion\\Run", 
-                          0, KEY_WRITE, &hKey);
-    
-    if (result == ERROR_SUCCESS) {
-        RegSetValueExA(hKey, "TelemetryService", 0, REG_SZ, 
-                      (BYTE*)exePath, (DWORD)strlen(exePath) + 1);
-        printf("  [+] Created Run registry entry (Startup)\n");
-        RegCloseKey(hKey);
-    } else {
-        printf("  [-] Failed to create Run entry (Error: %ld)\n", result);
+    printf("%-28s %12s %12s %9s\n", "metric", "old", "new", "delta");
+    for (int i = 0; i < newCount; i++) {
+        if (strcmp(newM[i].name, "schema") == 0) {
+            continue;
+        }
+        for (int j = 0; j < oldCount; j++) {
+            if (strcmp(newM[i].name, oldM[j].name) != 0) {
+                continue;
+            }
+            double delta = oldM[j].value != 0.0
+                ? (newM[i].value - oldM[j].value) * 100.0 / oldM[j].value
+                : 0.0;
+            int bad = ReportIsRegression(newM[i].name, delta);
+            printf("%-28s %12.1f %12.1f %+8.1f%%%s\n",
+                   newM[i].name, oldM[j].value, newM[i].value, delta,
+                   bad ? "  << REGRESSION" : "");
+            regressions += bad;
+            break;
+        }
     }
 
-    // Create custom registry key for additional telemetry
-    result = RegCreateKeyExA(HKEY_CURRENT_USER, 
-                            "Software\\TelemetryTest", 
-                            0, NULL, REG_OPTION_NON_VOLATILE, 
-                            KEY_WRITE, NULL, &hKey, NULL);
-    
-    if (result == ERROR_SUCCESS) {
-        DWORD installTime = (DWORD)time(NULL);
-        RegSetValueExA(hKey, "InstallTime", 0, REG_DWORD, 
-                      (BYTE*)&installTime, sizeof(DWORD));
-        RegSetValueExA(hKey, "Version", 0, REG_SZ, 
-                      (BYTE*)"1.0.0", 6);
-        printf("  [+] Created custom registry key with values\n");
-        RegCloseKey(hKey);
+    if (regressions > 0) {
+        printf("\n[-] %d metric(s) regressed beyond %.0f%%\n",
+               regressions, REPORT_THRESHOLD_PCT);
+        return 2;
     }
+    printf("\n[+] No regressions beyond %.0f%%\n", REPORT_THRESHOLD_PCT);
+    return 0;
 }
 
-void MakeWebRequests() {
-    const char* urls[] = {
-        "http://example.com/c2/beacon",
-        "http://httpbin.org/get",
-        "http://www.google.com",
-        "http://api.ipify.org",
-        "http://checkip.amazonaws.com"
-    };
-    
-    int numUrls = sizeof(urls) / sizeof(urls[0]);
-    
-    for (int i = 0; i < numUrls; i++) {
-        HINTERNET hInternet = InternetOpenA("TelemetryBot/1.0", 
-                                           INTERNET_OPEN_TYPE_DIRECT, 
-                                           NULL, NULL, 0);
-        
-        if (hInternet) {
-            HINTERNET hConnect = InternetOpenUrlA(hInternet, urls[i], 
-                                                 NULL, 0, 
-                                                 INTERNET_FLAG_RELOAD, 0);
-            
-            if (hConnect) {
-                char buffer[4096];
-                DWORD bytesRead;
-                
-                if (InternetReadFile(hConnect, buffer, sizeof(buffer), &bytesRead)) {
-                    printf("  [+] Connected to: %s (%lu bytes)\n", urls[i], bytesRead);
-                } else {
-                    printf("  [~] Request to: %s (no data)\n", urls[i]);
-                }
-                
-                InternetCloseHandle(hConnect);
-            } else {
-                printf("  [-] Failed to connect to: %s\n", urls[i]);
+#pragma pack(push, 1)
+typedef struct TraceHeader {
+    char magic[4];       // "VDTR"
+    USHORT version;
+    USHORT reserved;
+    ULONGLONG seed;
+    ULONGLONG perfFreq;  // ticks/sec for the record timestamps
+} TraceHeader;
+
+typedef struct TraceRecord {
+    ULONGLONG qpc;       // QueryPerformanceCounter at emission
+    ULONGLONG seq;       // global event sequence number (64-bit since v2)
+} TraceRecord;
+#pragma pack(pop)
+
+#define TRACE_BATCH 1024
+
+FILE* g_traceFile = NULL;
+CRITICAL_SECTION g_traceLock;
+TraceRecord g_traceBuf[TRACE_BATCH];
+int g_traceCount = 0;
+
+void TraceInit(const char* path) {
+    TraceHeader header;
+    LARGE_INTEGER freq;
+
+    g_traceFile = fopen(path, "wb");
+    if (g_traceFile == NULL) {
+        printf("[-] Could not open trace file: %s\n", path);
+        return;
+    }
+    InitializeCriticalSection(&g_traceLock);
+
+    QueryPerformanceFrequency(&freq);
+    memcpy(header.magic, "VDTR", 4);
+    header.version = 2; // v2: 64-bit record seq
+    header.reserved = 0;
+    header.seed = g_rngSeed;
+    header.perfFreq = (ULONGLONG)freq.QuadPart;
+    fwrite(&header, sizeof(header), 1, g_traceFile);
+    printf("[*] Recording event trace to %s\n", path);
+}
+
+static void TraceFlushLocked() {
+    if (g_traceCount > 0) {
+        fwrite(g_traceBuf, sizeof(TraceRecord), g_traceCount, g_traceFile);
+        g_traceCount = 0;
+    }
+}
+
+static void TraceEvent(LONGLONG seq) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    EnterCriticalSection(&g_traceLock);
+    g_traceBuf[g_traceCount].qpc = (ULONGLONG)now.QuadPart;
+    g_traceBuf[g_traceCount].seq = (ULONGLONG)seq;
+    if (++g_traceCount == TRACE_BATCH) {
+        TraceFlushLocked();
+    }
+    LeaveCriticalSection(&g_traceLock);
+}
+
+void TraceClose() {
+    if (g_traceFile != NULL) {
+        EnterCriticalSection(&g_traceLock);
+        TraceFlushLocked();
+        LeaveCriticalSection(&g_traceLock);
+        fclose(g_traceFile);
+        g_traceFile = NULL;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Token-bucket rate scheduler
+//
+// Replaces the old SleepRandom()-style pacing for load runs. Workers call
+// RateWaitToken() before every telemetry-generating operation; with
+// --eps N the aggregate event rate across all workers converges on N
+// events/sec with a flat, reproducible curve. Waits of 2 ms or more go
+// through a high-resolution waitable timer; shorter gaps use a
+// QueryPerformanceCounter spin so sub-millisecond spacing is possible
+// (Sleep() granularity is ~15 ms and useless at 1k+ eps).
+// ---------------------------------------------------------------------------
+
+typedef struct RateLimiter {
+    CRITICAL_SECTION lock;
+    double eps;            // refill rate, tokens/sec
+    double tokens;         // current bucket level
+    double capacity;       // burst ceiling (~50 ms of tokens)
+    LARGE_INTEGER lastRefill;
+} RateLimiter;
+
+RateLimiter g_rate;
+volatile LONG g_rateActive = 0; // pacing on (eps > 0)
+volatile LONG g_ratePaused = 0; // burst-profile off period: hold all workers
+
+// Per-thread timer so workers never contend on a shared handle
+TG_THREAD_LOCAL HANDLE t_rateTimer = NULL;
+
+void RateInit(int eps) {
+    QueryPerformanceFrequency(&g_perfFreq);
+    InitializeCriticalSection(&g_rate.lock);
+    g_rate.tokens = 0;
+    RateSetEps((double)eps);
+}
+
+// Retarget the bucket on the fly; the phase scheduler calls this while
+// the workers are running
+void RateSetEps(double eps) {
+    EnterCriticalSection(&g_rate.lock);
+    g_rate.eps = eps;
+    g_rate.capacity = eps / 20.0;
+    if (g_rate.capacity < 1.0) g_rate.capacity = 1.0;
+    if (g_rate.tokens > g_rate.capacity) {
+        g_rate.tokens = g_rate.capacity;
+    }
+    QueryPerformanceCounter(&g_rate.lastRefill);
+    LeaveCriticalSection(&g_rate.lock);
+    InterlockedExchange(&g_rateActive, eps > 0.0 ? 1 : 0);
+}
+
+void RatePause(int paused) {
+    InterlockedExchange(&g_ratePaused, paused);
+}
+
+// Sleep precisely for waitSec: waitable timer for long waits, spin for short
+static void RateSleep(double waitSec) {
+    if (waitSec >= 0.002) {
+        if (t_rateTimer == NULL) {
+            // High-resolution timers need Win10 1803+; fall back quietly
+            t_rateTimer = CreateWaitableTimerExW(NULL, NULL,
+                              CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                              TIMER_ALL_ACCESS);
+            if (t_rateTimer == NULL) {
+                t_rateTimer = CreateWaitableTimerExW(NULL, NULL, 0,
+                                  TIMER_ALL_ACCESS);
             }
-            
-            InternetCloseHandle(hInternet);
         }
-        
-        Sleep(500 + (rand() % 1000)); // Random delay between requests
+        if (t_rateTimer != NULL) {
+            LARGE_INTEGER due;
+            due.QuadPart = -(LONGLONG)(waitSec * 10000000.0); // 100 ns units
+            SetWaitableTimer(t_rateTimer, &due, 0, NULL, NULL, FALSE);
+            WaitForSingleObject(t_rateTimer, INFINITE);
+            return;
+        }
+        Sleep((DWORD)(waitSec * 1000.0));
+        return;
     }
+
+    // Sub-2ms: calibrated spin on the performance counter
+    LARGE_INTEGER now, deadline;
+    QueryPerformanceCounter(&now);
+    deadline.QuadPart = now.QuadPart +
+                        (LONGLONG)(waitSec * (double)g_perfFreq.QuadPart);
+    do {
+        YieldProcessor();
+        QueryPerformanceCounter(&now);
+    } while (now.QuadPart < deadline.QuadPart && !g_stop);
 }
 
-void CreateFiles() {
-    char tempPath[MAX_PATH];
-    char filePath[MAX_PATH];
-    
-    GetTempPathA(MAX_PATH, tempPath);
-    
-    // Create a suspicious config file
-    snprintf(filePath, MAX_PATH, "%s\\telemetry_config.dat", tempPath);
-    HANDLE hFile = CreateFileA(filePath, GENERIC_WRITE, 0, NULL, 
-                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-    
-    if (hFile != INVALID_HANDLE_VALUE) {
-        const char* configData = "C2_SERVER=example.com\nBEACON_INTERVAL=60\nENCRYPTION_KEY=ABC123\n";
-        DWORD bytesWritten;
-        WriteFile(hFile, configData, (DWORD)strlen(configData), &bytesWritten, NULL);
-        CloseHandle(hFile);
-        printf("  [+] Created config file: %s\n", filePath);
+// Block until one token is available. No-op when pacing is off.
+void RateWaitToken() {
+    while (g_ratePaused && !g_stop) {
+        Sleep(5); // burst off-period: emission fully held
+    }
+    if (!g_rateActive) {
+        return;
     }
 
-    // Create a log file
-    snprintf(filePath, MAX_PATH, "%s\\telemetry_log.txt", tempPath);
-    hFile = CreateFileA(filePath, GENERIC_WRITE, 0, NULL, 
-                       CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-    
-    if (hFile != INVALID_HANDLE_VALUE) {
-        char logData[256];
-        snprintf(logData, sizeof(logData), 
-                 "[%lu] Telemetry test started\n[%lu] System check complete\n", 
-                 (unsigned long)time(NULL), (unsigned long)time(NULL) + 1);
-        DWORD bytesWritten;
-        WriteFile(hFile, logData, (DWORD)strlen(logData), &bytesWritten, NULL);
-        CloseHandle(hFile);
-        printf("  [+] Created log file: %s\n", filePath);
+    for (;;) {
+        double waitSec;
+
+        EnterCriticalSection(&g_rate.lock);
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        double elapsed = (double)(now.QuadPart - g_rate.lastRefill.QuadPart) /
+                         (double)g_perfFreq.QuadPart;
+        g_rate.tokens += elapsed * g_rate.eps;
+        if (g_rate.tokens > g_rate.capacity) {
+            g_rate.tokens = g_rate.capacity;
+        }
+        g_rate.lastRefill = now;
+
+        if (g_rate.tokens >= 1.0) {
+            g_rate.tokens -= 1.0;
+            LeaveCriticalSection(&g_rate.lock);
+            return;
+        }
+        waitSec = (1.0 - g_rate.tokens) / g_rate.eps;
+        LeaveCriticalSection(&g_rate.lock);
+
+        if (g_stop) {
+            return;
+        }
+        RateSleep(waitSec);
     }
+}
 
-    // Create a hidden file
-    snprintf(filePath, MAX_PATH, "%s\\.telemetry_cache", tempPath);
-    hFile = CreateFileA(filePath, GENERIC_WRITE, 0, NULL, 
-                       CREATE_ALWAYS, FILE_ATTRIBUTE_HIDDEN, NULL);
-    
-    if (hFile != INVALID_HANDLE_VALUE) {
-        const char* cacheData = "CACHED_DATA_12345";
-        DWORD bytesWritten;
-        WriteFile(hFile, cacheData, (DWORD)strlen(cacheData), &bytesWritten, NULL);
-        CloseHandle(hFile);
-        printf("  [+] Created hidden file: %s\n", filePath);
+// ---------------------------------------------------------------------------
+// Phase scheduler
+//
+// A profile turns the flat worker loop into shaped load: a list of
+// phases, each with a duration, a target rate and an event mix, driven
+// by retargeting the token bucket while the workers run. "ramp" walks
+// the rate linearly from the previous phase's rate to its own target,
+// "burst" square-waves between the target and a full hold (the pattern
+// that historically made the backend's WebSocket stream drop frames),
+// and "steady" just holds the target. The mix mask picks which of the
+// five generators are live in that phase.
+// ---------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------
+// Compile-time scenario specialization
+//
+// build.bat's matrix passes /DTG_SCENARIO_* to bake a scenario into its
+// own binary: the worker's generator mix becomes a compile-time
+// constant (so the per-pass dispatch branches fold away) and the
+// scenario's defaults are applied before the command line is parsed.
+// Building with no scenario define produces the general interactive
+// binary, unchanged.
+// ---------------------------------------------------------------------------
+
+#if defined(TG_SCENARIO_FIRE)
+#define TG_SCENARIO_NAME "fire"
+#elif defined(TG_SCENARIO_DNS)
+#define TG_SCENARIO_NAME "dns"
+#define TG_FORCED_MIX MIX_DNS
+#elif defined(TG_SCENARIO_REG)
+#define TG_SCENARIO_NAME "reg"
+#define TG_FORCED_MIX MIX_REGISTRY
+#elif defined(TG_SCENARIO_NET)
+#define TG_SCENARIO_NAME "net"
+#define TG_FORCED_MIX (MIX_WEB | MIX_DNS)
+#else
+#define TG_SCENARIO_NAME "general"
+#endif
+
+// Baked defaults for the specialized binaries; all still overridable
+// from the command line
+static void ApplyScenarioDefaults() {
+#if defined(TG_SCENARIO_FIRE)
+    g_config.firehosePath = "\\\\.\\pipe\\voodoobox-telemetry";
+    g_config.fireEvents = 1000000;
+#elif defined(TG_SCENARIO_DNS)
+    g_config.dnsDga = 1;
+    g_config.dnsQueries = 1000;
+    g_config.dnsInflight = 128;
+#elif defined(TG_SCENARIO_REG)
+    g_config.regOps = 256;
+    g_config.regFanout = 16;
+#elif defined(TG_SCENARIO_NET)
+    g_config.beacons = 50;
+    g_config.dnsQueries = 100;
+#endif
+}
+
+ProfilePhase g_profile[PROFILE_MAX_PHASES];
+int g_profileCount = 0;
+volatile LONG g_phaseMix = MIX_ALL; // workers read this every pass
+
+// The spec grammar and parser are shared with the Linux binary; see
+// ParseProfileSpec() in telemetry_core.h. Returns 0 on a bad spec.
+int ParseProfile(const char* spec) {
+    g_profileCount = ParseProfileSpec(spec, g_profile, PROFILE_MAX_PHASES);
+    return g_profileCount > 0;
+}
+
+// Runs on the main thread while the worker pool is live; returns when
+// the last phase ends (the caller raises g_stop).
+void RunProfileScheduler() {
+    int prevRate = 0;
+
+    for (int i = 0; i < g_profileCount && !g_stop; i++) {
+        ProfilePhase* p = &g_profile[i];
+        TgLog("[*] Phase %d/%d: %s %ds @ %d eps\n",
+              i + 1, g_profileCount, p->name, p->durationSec, p->rate);
+
+        InterlockedExchange(&g_phaseMix, p->mix);
+
+        int steps = p->durationSec * 1000 / PROFILE_STEP_MS;
+        for (int s = 0; s < steps && !g_stop; s++) {
+            switch (p->kind) {
+                case PHASE_RAMP:
+                    RateSetEps(prevRate +
+                               (double)(p->rate - prevRate) * (s + 1) / steps);
+                    break;
+                case PHASE_BURST: {
+                    int elapsedMs = s * PROFILE_STEP_MS;
+                    int on = (elapsedMs / BURST_HALF_PERIOD_MS) % 2 == 0;
+                    RateSetEps((double)p->rate);
+                    RatePause(!on);
+                    break;
+                }
+                case PHASE_STEADY:
+                    if (s == 0) {
+                        RateSetEps((double)p->rate);
+                    }
+                    break;
+            }
+            Sleep(PROFILE_STEP_MS);
+        }
+
+        RatePause(0);
+        prevRate = p->rate;
     }
 }
 
-void PerformDNSLookups() {
-    const char* domains[] = {
-        "malware-traffic-analysis.net",
-        "example.com",
-        "google.com",
-        "github.com",
-        "suspicious-domain-test.com"
+// ---------------------------------------------------------------------------
+// Micro-benchmark harness
+//
+// --bench times each generator function on its own: a short warmup, then
+// a calibrated loop that doubles the batch size until a run is long
+// enough to trust, reported as ns/op and ops/sec. Running this twice -
+// agent attached and not - is how sensor overhead per telemetry class
+// is measured, so the output is one parseable CSV line per function on
+// top of the human summary.
+// ---------------------------------------------------------------------------
+
+#define BENCH_WARMUP_ITERS 3
+#define BENCH_MIN_RUN_NS 1000000000ULL  // calibrate up to a ~1s measurement
+
+typedef struct BenchCase {
+    const char* name;
+    void (*fn)(void);
+} BenchCase;
+
+static ULONGLONG BenchRun(void (*fn)(void), int iters) {
+    LARGE_INTEGER start, end;
+    QueryPerformanceCounter(&start);
+    for (int i = 0; i < iters; i++) {
+        fn();
+    }
+    QueryPerformanceCounter(&end);
+    return (ULONGLONG)(end.QuadPart - start.QuadPart) * 1000000000ULL /
+           (ULONGLONG)g_perfFreq.QuadPart;
+}
+
+int RunBench() {
+    BenchCase cases[] = {
+        { "mutex",    CreateTestMutex },
+        { "registry", CreateRegistryEntries },
+        { "http",     MakeWebRequests },
+        { "files",    CreateFiles },
+        { "dns",      PerformDNSLookups },
     };
-    
-    int numDomains = sizeof(domains) / sizeof(domains[0]);
-    
-    for (int i = 0; i < numDomains; i++) {
-        struct hostent* host = gethostbyname(domains[i]);
-        
-        if (host != NULL) {
-            struct in_addr addr;
-            addr.s_addr = *(u_long*)host->h_addr_list[0];
-            printf("  [+] DNS lookup: %s -> %s\n", domains[i], inet_ntoa(addr));
-        } else {
-            printf("  [-] DNS lookup failed: %s\n", domains[i]);
+    int numCases = sizeof(cases) / sizeof(cases[0]);
+
+    // Pacing and per-event logging would be measuring ourselves
+    RateSetEps(0.0);
+    g_config.quiet = 1;
+
+    printf("[*] Benchmarking %d generator functions...\n\n", numCases);
+    printf("%-10s %10s %14s %14s\n", "function", "iters", "ns/op", "ops/sec");
+
+    for (int c = 0; c < numCases; c++) {
+        BenchRun(cases[c].fn, BENCH_WARMUP_ITERS);
+
+        // Double the batch until the measurement is long enough
+        int iters = 1;
+        ULONGLONG elapsedNs = BenchRun(cases[c].fn, iters);
+        while (elapsedNs < BENCH_MIN_RUN_NS && iters < (1 << 20) && !g_stop) {
+            iters *= 2;
+            elapsedNs = BenchRun(cases[c].fn, iters);
         }
-        
-        Sleep(300);
+        if (elapsedNs == 0) elapsedNs = 1;
+
+        double nsPerOp = (double)elapsedNs / iters;
+        double opsPerSec = 1e9 / nsPerOp;
+        printf("%-10s %10d %14.0f %14.1f\n",
+               cases[c].name, iters, nsPerOp, opsPerSec);
+        // Machine-readable line for the harness to diff agent-on/off
+        printf("BENCH,%s,%d,%.0f,%.1f\n",
+               cases[c].name, iters, nsPerOp, opsPerSec);
     }
+
+    printf("\n[+] Benchmark complete\n");
+    return 0;
 }
 
-void CreateTestMutex() {
-    HANDLE hMutex = CreateMutexA(NULL, FALSE, "Global\\TelemetryTestMutex");
-    
-    if (hMutex != NULL) {
-        if (GetLastError() == ERROR_ALREADY_EXISTS) {
-            printf("  [!] Mutex already exists - another instance running?\n");
+int main(int argc, char* argv[]) {
+    LARGE_INTEGER launchQpc;
+    QueryPerformanceCounter(&launchQpc); // for the fast-start readiness figure
+
+    // Re-exec'd tree nodes skip all setup and just build their subtree
+    if (argc >= 3 && strcmp(argv[1], "--tree-node") == 0) {
+        int nodeDepth = atoi(argv[2]);
+        int nodeWidth = (argc >= 5 && strcmp(argv[3], "--spawn-width") == 0)
+                            ? atoi(argv[4]) : 2;
+        return TreeNodeMain(nodeDepth, nodeWidth);
+    }
+
+    // Detonation windows are short: --fast-start must be known before
+    // we decide to pay for a console, so pre-scan for it
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fast-start") == 0) {
+            g_config.fastStart = 1;
+            break;
+        }
+    }
+
+    // Ensure we have a console window (skipped on fast starts - console
+    // allocation alone can eat most of a 100 ms budget)
+    if (!g_config.fastStart && !GetConsoleWindow()) {
+        AllocConsole();
+        freopen("CONOUT$", "w", stdout);
+        freopen("CONOUT$", "w", stderr);
+    }
+
+    // Set unbuffered output for real-time streaming to screen
+    if (!g_config.fastStart) {
+        setvbuf(stdout, NULL, _IONBF, 0);
+    }
+
+    // Scenario binaries start from their baked defaults; the command
+    // line can still override any of them
+    ApplyScenarioDefaults();
+
+    // Parse command line
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            g_config.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            g_config.durationSec = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            g_config.loops = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--beacons") == 0 && i + 1 < argc) {
+            g_config.beacons = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--http-pool") == 0 && i + 1 < argc) {
+            g_config.httpPool = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dns-queries") == 0 && i + 1 < argc) {
+            g_config.dnsQueries = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dns-inflight") == 0 && i + 1 < argc) {
+            g_config.dnsInflight = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dns-server") == 0 && i + 1 < argc) {
+            g_config.dnsServer = argv[++i];
+        } else if (strcmp(argv[i], "--dga") == 0) {
+            g_config.dnsDga = 1;
+        } else if (strcmp(argv[i], "--eps") == 0 && i + 1 < argc) {
+            g_config.eps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--reg-ops") == 0 && i + 1 < argc) {
+            g_config.regOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--reg-fanout") == 0 && i + 1 < argc) {
+            g_config.regFanout = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--file-ops") == 0 && i + 1 < argc) {
+            g_config.fileOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--file-dirs") == 0 && i + 1 < argc) {
+            g_config.fileDirs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--spawn-depth") == 0 && i + 1 < argc) {
+            g_config.spawnDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--spawn-width") == 0 && i + 1 < argc) {
+            g_config.spawnWidth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            g_config.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            g_config.tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            g_config.quiet = 1;
+        } else if (strcmp(argv[i], "--firehose") == 0 && i + 1 < argc) {
+            g_config.firehosePath = argv[++i];
+        } else if (strcmp(argv[i], "--fire-events") == 0 && i + 1 < argc) {
+            g_config.fireEvents = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            g_config.profile = argv[++i];
+        } else if (strcmp(argv[i], "--obj-ops") == 0 && i + 1 < argc) {
+            g_config.objOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--obj-batch") == 0 && i + 1 < argc) {
+            g_config.objBatch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            g_config.soakHours = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--swarm") == 0 && i + 1 < argc) {
+            g_config.swarm = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--swarm-worker") == 0 && i + 1 < argc) {
+            g_config.swarmWorker = atoi(argv[++i]); // internal: set by parent
+        } else if (strcmp(argv[i], "--swarm-key") == 0 && i + 1 < argc) {
+            g_config.swarmKey = (DWORD)atoi(argv[++i]); // internal
+        } else if (strcmp(argv[i], "--targets") == 0 && i + 1 < argc) {
+            g_config.targetsPath = argv[++i];
+        } else if (strcmp(argv[i], "--xfer") == 0 && i + 1 < argc) {
+            g_config.xferOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--xfer-server") == 0 && i + 1 < argc) {
+            g_config.xferServer = argv[++i];
+        } else if (strcmp(argv[i], "--xfer-min") == 0 && i + 1 < argc) {
+            g_config.xferMinKb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--xfer-max") == 0 && i + 1 < argc) {
+            g_config.xferMaxKb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            g_config.bench = 1;
+        } else if (strcmp(argv[i], "--conn") == 0 && i + 1 < argc) {
+            g_config.connOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--conn-server") == 0 && i + 1 < argc) {
+            g_config.connServer = argv[++i];
+        } else if (strcmp(argv[i], "--seq-table") == 0) {
+            g_config.seqTable = 1;
+        } else if (strcmp(argv[i], "--find-max") == 0) {
+            g_config.findMax = 1;
+        } else if (strcmp(argv[i], "--payload-kb") == 0 && i + 1 < argc) {
+            g_config.payloadKb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--payload-entropy") == 0 && i + 1 < argc) {
+            g_config.payloadEntropy = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dll-ops") == 0 && i + 1 < argc) {
+            g_config.dllOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dll-stubs") == 0 && i + 1 < argc) {
+            g_config.dllStubs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fast-start") == 0) {
+            g_config.fastStart = 1;
+        } else if (strcmp(argv[i], "--affinity") == 0) {
+            g_config.affinity = 1;
+        } else if (strcmp(argv[i], "--reserve-cores") == 0 && i + 1 < argc) {
+            g_config.reserveCores = atoi(argv[++i]);
+            g_config.affinity = 1;
+        } else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            g_config.reportPath = argv[++i];
+        } else if (strcmp(argv[i], "--dns-fast") == 0) {
+            g_config.dnsFast = 1;
+        } else if (strcmp(argv[i], "--etw") == 0 && i + 1 < argc) {
+            g_config.etwEvents = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+            // Offline mode: diff two run reports and flag regressions
+            const char* oldPath = argv[++i];
+            const char* newPath = argv[++i];
+            return ReportCompare(oldPath, newPath);
+        } else if (strcmp(argv[i], "--build-targets") == 0 && i + 2 < argc) {
+            // Offline mode: compile a text list into the binary format
+            const char* inPath = argv[++i];
+            const char* outPath = argv[++i];
+            return TargetsBuild(inPath, outPath) ? 0 : 1;
+
+        } else if (strcmp(argv[i], "--wait") == 0) {
+            g_config.wait = 1;
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "/?") == 0) {
+            PrintUsage(argv[0]);
+            return 0;
         } else {
-            printf("  [+] Created mutex: Global\\TelemetryTestMutex\n");
+            printf("[-] Unknown option: %s\n", argv[i]);
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Interactive runs (no arguments) keep the old demo behavior:
+    // a single pass and a keypress before the console closes.
+    if (argc == 1) {
+        g_config.wait = 1;
+    }
+
+    // Swarm parent: launch the worker copies and aggregate; everything
+    // below this point is the single-process flow the children run
+    if (g_config.swarm > 0 && g_config.swarmWorker < 0) {
+        return RunSwarmParent(argc, argv);
+    }
+
+    if (g_config.findMax) {
+        // The controller owns the clock and the rate; workers just run
+        g_config.seqTable = 1;
+        g_config.durationSec = 24 * 3600; // controller stops the run
+        g_config.wait = 0;
+    }
+
+    if (g_config.soakHours > 0) {
+        // Soak runs are timed, unattended, and must not leave artifacts
+        g_config.durationSec = g_config.soakHours * 3600;
+        g_config.wait = 0;
+    }
+
+    if (g_config.profile != NULL) {
+        if (!ParseProfile(g_config.profile)) {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        // Workers run for the profile's total length; the scheduler owns
+        // the rate and the mix from here on
+        g_config.durationSec = 0;
+        for (int i = 0; i < g_profileCount; i++) {
+            g_config.durationSec += g_profile[i].durationSec;
         }
     }
+
+    if (g_config.threads <= 0) {
+        SYSTEM_INFO sysInfo;
+        GetSystemInfo(&sysInfo);
+        g_config.threads = (int)sysInfo.dwNumberOfProcessors;
+    }
+    if (g_config.threads > MAXIMUM_WAIT_OBJECTS) {
+        g_config.threads = MAXIMUM_WAIT_OBJECTS;
+    }
+    if (g_config.loops < 1) {
+        g_config.loops = 1;
+    }
+
+    if (g_config.fastStart) {
+        g_config.quiet = 1;
+        g_config.wait = 0;
+    } else {
+        printf("====================================================\n");
+        printf("        MALWARE LAB TELEMETRY GENERATOR             \n");
+        printf("====================================================\n");
+        printf("[*] Workers: %d  Duration: %s  Scenario: %s\n", g_config.threads,
+               g_config.durationSec > 0 ? "timed" : "fixed passes",
+               TG_SCENARIO_NAME);
+        printf("[*] Starting telemetry generation stream...\n\n");
+    }
+
+    // Initialize Winsock
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        printf("[-] WSAStartup failed\n");
+        return 1;
+    }
+
+    // Seed the PRNG streams: a fixed --seed makes timing, DGA domains
+    // and payload bytes identical run to run for A/B benchmarking
+    g_rngSeed = g_config.seed != 0 ? (ULONGLONG)g_config.seed
+                                   : (ULONGLONG)time(NULL);
+
+    if (g_config.tracePath != NULL) {
+        TraceInit(g_config.tracePath);
+    }
+
+    // Map the target list up front; the engines index it in place
+    if (g_config.targetsPath != NULL && !TargetsLoad(g_config.targetsPath)) {
+        WSACleanup();
+        return 1;
+    }
+
+    // Rate scheduler (no-op unless --eps was given)
+    RateInit(g_config.eps);
+
+    if (g_config.seqTable && !SeqTableInit()) {
+        // The adaptive controller is a closed loop over the table's
+        // ingestion counters; without them it has nothing to measure
+        if (g_config.findMax) {
+            printf("[-] --find-max needs the sequence table, aborting\n");
+            WSACleanup();
+            return 1;
+        }
+        printf("[!] Sequence table disabled - shared section unavailable\n");
+        g_config.seqTable = 0;
+    }
+
+    // Open and cache every registry handle the run will touch
+    InitRegistryEngine(g_config.regFanout);
+
+    // Build the temp directory tree and payload pool for file churn
+    InitFileEngine(g_config.fileDirs);
+
+    // Stage the module-load rotation (system DLLs plus generated stubs)
+    if (g_config.dllOps > 0) {
+        InitDllEngine(g_config.dllStubs);
+    }
+
+    // Enumerate topology and build the placement table before any
+    // worker exists, so pinning is a table lookup per thread
+    if (g_config.affinity && !InitCpuTopology()) {
+        printf("[!] Affinity disabled - topology enumeration failed\n");
+        g_config.affinity = 0;
+    }
+
+    // Resolve beacon targets once, before the workers start -
+    // gethostbyname is not safe to call from multiple threads. Fast
+    // starts read the addresses a previous run cached instead: name
+    // resolution is the dominant (and network-bound) startup cost.
+    if (g_config.fastStart && FastStartLoad()) {
+        // resolved from the warm cache, nothing to do
+    } else if (InitBeaconTargets() == 0) {
+        printf("[!] No beacon targets resolved - HTTP phase will be skipped\n");
+    } else {
+        FastStartSave(); // prime the cache for the next fast start
+    }
+
+    if (g_config.xferOps > 0 && !InitXferEngine()) {
+        printf("[!] Transfer engine disabled - bad --xfer-server address\n");
+        g_config.xferOps = 0;
+    }
+
+    if (g_config.connOps > 0 && !InitConnEngine()) {
+        printf("[!] Connection churn disabled - bad --conn-server list\n");
+        g_config.connOps = 0;
+    }
+
+    if (g_config.dnsFast && !InitDnsFastPath()) {
+        printf("[!] DNS fast path disabled - falling back to per-query encode\n");
+        g_config.dnsFast = 0;
+    }
+
+    // Benchmark mode: engines are initialized, workers are not - time
+    // each generator single-threaded and exit
+    if (g_config.bench) {
+        int rc = RunBench();
+        TraceClose();
+        CloseRegistryEngine();
+        CloseFileEngine();
+        WSACleanup();
+        return rc;
+    }
+
+    printf("[STREAM] Generating mutex, registry, network, file and DNS telemetry...\n");
+
+    ULONGLONG startTick = GetTickCount64();
+
+    // From here on, hot-path output goes through the log ring
+    LogInit();
+
+    if (g_config.soakHours > 0) {
+        CleanupStart();
+    }
+
+    // Swarm children report ready and hold here until the parent fires
+    // the start event, so all workers begin emitting at the same instant
+    if (g_config.swarmWorker >= 0) {
+        SwarmChildArrive();
+    }
+
+    if (g_config.fastStart) {
+        LARGE_INTEGER readyQpc;
+        QueryPerformanceCounter(&readyQpc);
+        printf("[*] Fast start: emitting %.1f ms after launch\n",
+               (readyQpc.QuadPart - launchQpc.QuadPart) * 1000.0 /
+                   (double)g_perfFreq.QuadPart);
+    }
+
+    if (g_config.firehosePath != NULL) {
+        // Firehose bypasses the syscall engines entirely: one channel,
+        // one writer, run on the main thread
+        RunFirehose();
+    } else if (g_config.etwEvents > 0) {
+        // ETW mode likewise runs on the main thread; the kernel's
+        // per-session buffers do the fan-in
+        RunEtwMode();
+    } else {
+        // Spin up the worker pool; every worker drives all five generators
+        HANDLE workers[MAXIMUM_WAIT_OBJECTS];
+        for (int i = 0; i < g_config.threads; i++) {
+            workers[i] = CreateThread(NULL, 0, GeneratorWorker, (LPVOID)(INT_PTR)i, 0, NULL);
+            if (workers[i] == NULL) {
+                printf("[-] Failed to create worker %d (Error: %lu)\n", i, GetLastError());
+                g_config.threads = i;
+                break;
+            }
+        }
+
+        if (g_config.threads == 0) {
+            printf("[-] No workers started, aborting\n");
+            WSACleanup();
+            return 1;
+        }
+
+        // Adaptive runs hand the clock to the controller, profile runs to
+        // the phase scheduler; plain timed runs sleep it out; fixed-pass
+        // runs just wait for every worker to finish its loops.
+        if (g_config.findMax) {
+            RunAdaptiveController();
+            InterlockedExchange(&g_stop, 1);
+        } else if (g_profileCount > 0) {
+            RunProfileScheduler();
+            InterlockedExchange(&g_stop, 1);
+        } else if (g_config.durationSec > 0) {
+            Sleep((DWORD)g_config.durationSec * 1000);
+            InterlockedExchange(&g_stop, 1);
+        }
+        WaitForMultipleObjects((DWORD)g_config.threads, workers, TRUE, INFINITE);
+
+        for (int i = 0; i < g_config.threads; i++) {
+            CloseHandle(workers[i]);
+        }
+    }
+
+    ULONGLONG elapsedMs = GetTickCount64() - startTick;
+    if (elapsedMs == 0) elapsedMs = 1;
+
+    CleanupStop();
+
+    // Drain and stop the log writer before printing the report
+    LogShutdown();
+
+    printf("\n[+] Telemetry generation complete!\n");
+    PrintLatencyReport();
+    printf("[*] Events emitted: %lld in %.1f sec (%.1f events/sec)\n",
+           (long long)g_eventsEmitted, elapsedMs / 1000.0,
+           g_eventsEmitted * 1000.0 / elapsedMs);
+
+    if (g_config.reportPath != NULL) {
+        WriteRunReport(g_config.reportPath, elapsedMs);
+    }
+
+    if (g_config.swarmWorker >= 0) {
+        SwarmChildReport();
+    }
+
+    if (g_config.wait) {
+        printf("[*] Press any key to exit...\n");
+        getchar();
+    }
+
+    TraceClose();
+    CloseRegistryEngine();
+    CloseFileEngine();
+    CloseDllEngine();
+    WSACleanup();
+    return 0;
+}
+
+void PrintUsage(const char* exeName) {
+    printf("Usage: %s [options]\n", exeName);
+    printf("\n");
+    printf("Options:\n");
+    printf("  --threads N    worker threads (default: one per logical CPU)\n");
+    printf("  --duration S   run for S seconds instead of a fixed pass count\n");
+    printf("  --loops N      passes per worker when no duration is set (default: 1)\n");
+    printf("  --beacons N    HTTP beacons per worker pass (default: 5)\n");
+    printf("  --http-pool N  pooled keep-alive connections per worker (default: 4)\n");
+    printf("  --dns-queries N  DNS queries per worker pass (default: 5)\n");
+    printf("  --dns-inflight N concurrent in-flight queries per worker (default: 16)\n");
+    printf("  --dns-server IP  resolver for the UDP DNS engine (default: 8.8.8.8)\n");
+    printf("  --dga          query DGA-style random domains instead of the fixed list\n");
+    printf("  --eps N        pace all workers to N aggregate events/sec\n");
+    printf("  --reg-ops N    registry churn set/delete ops per worker pass (default: 16)\n");
+    printf("  --reg-fanout N churn subkeys under Software\\TelemetryTest (default: 4)\n");
+    printf("  --file-ops N   file create/write/delete cycles per worker pass (default: 8)\n");
+    printf("  --file-dirs N  temp subdirectories for file churn (default: 4)\n");
+    printf("  --spawn-depth N  process tree depth per pass (default: 0 = off)\n");
+    printf("  --spawn-width N  children per process tree node (default: 2)\n");
+    printf("  --seed N       deterministic PRNG seed for reproducible runs\n");
+    printf("  --trace FILE   record every event (seq, timestamp) to a binary trace\n");
+    printf("  --quiet        drop per-event output entirely (load runs)\n");
+    printf("  --firehose P   emit framed records directly to a pipe/port (e.g.\n");
+    printf("                 \\\\.\\pipe\\voodoobox-telemetry) instead of real syscalls\n");
+    printf("  --fire-events N  frames to emit in firehose mode (default: 100000)\n");
+    printf("  --etw N        write N structured events through a registered ETW\n");
+    printf("                 provider instead of performing real operations; the\n");
+    printf("                 agent's trace session consumes them like Sysmon events\n");
+    printf("  --obj-ops N    named-object ops per worker pass (default: 16)\n");
+    printf("  --soak H       run for H hours with concurrent self-cleanup so\n");
+    printf("                 disk and registry footprint stay flat\n");
+    printf("  --swarm N      launch N copies of this binary as worker processes\n");
+    printf("                 and print one combined events/sec figure\n");
+    printf("  --bench        time each generator function (warmup + calibrated\n");
+    printf("                 loop), print ns/op and ops/sec, then exit\n");
+    printf("  --seq-table    tag artifact names with sequence IDs and publish\n");
+    printf("                 per-ID emission timestamps in shared memory, so the\n");
+    printf("                 harness can measure end-to-end loss and latency\n");
+    printf("  --dns-fast     flood path: pre-serialized query packets from a\n");
+    printf("                 reusable ring, only the transaction ID patched per\n");
+    printf("                 send; warms the upstream cache at init\n");
+    printf("  --report F     write a machine-readable run report (CSV) at exit\n");
+    printf("  --compare OLD NEW  diff two run reports, flag rate or latency\n");
+    printf("                 changes beyond 10%%, exit 2 on regression\n");
+    printf("  --affinity     pin worker threads to cores by topology, one per\n");
+    printf("                 physical core before touching SMT siblings\n");
+    printf("  --reserve-cores N  leave the first N physical cores unpinned for\n");
+    printf("                 the sensor under test (implies --affinity)\n");
+    printf("  --fast-start   skip console allocation and the banner, resolve\n");
+    printf("                 beacon targets from the warm cache left by an\n");
+    printf("                 earlier run; full emission rate within ~100 ms\n");
+    printf("  --dll-ops N    module load/free cycles per worker pass (default: 0)\n");
+    printf("  --dll-stubs N  generated stub DLLs in the rotation (default: 4)\n");
+    printf("  --payload-kb N   churn-file payload size in KB (default: 4)\n");
+    printf("  --payload-entropy P  percent of payload blocks that are random\n");
+    printf("                 vs constant filler (default: 100)\n");
+    printf("  --find-max     closed loop against the harness's ingestion counter:\n");
+    printf("                 ramp, then binary-search the rate; print the max\n");
+    printf("                 sustainable events/sec at exit (implies --seq-table)\n");
+    printf("  --conn N       ephemeral TCP connect/close cycles per worker pass\n");
+    printf("                 (default: 0 = off)\n");
+    printf("  --conn-server L  churn targets, comma-separated host:port list\n");
+    printf("                 (default: 127.0.0.1:9)\n");
+    printf("  --xfer N       large HTTP transfers per worker pass against a\n");
+    printf("                 local echo server (default: 0 = off)\n");
+    printf("  --xfer-server H:P  echo server address (default: 127.0.0.1:8080)\n");
+    printf("  --xfer-min KB  transfer size lower bound (default: 4)\n");
+    printf("  --xfer-max KB  transfer size upper bound (default: 1024)\n");
+    printf("  --targets F    memory-mapped target file for DNS names and HTTP\n");
+    printf("                 Host headers (build with --build-targets)\n");
+    printf("  --build-targets IN OUT  compile a newline-delimited host list\n");
+    printf("                 into the mapped binary format, then exit\n");
+    printf("  --obj-batch N  handles held before a batched close (default: 64)\n");
+    printf("  --profile SPEC shaped load: comma list of KIND:SECS:RATE[:MIX] phases\n");
+    printf("                 KIND = steady|ramp|burst, MIX letters = m(utex)\n");
+    printf("                 r(egistry) w(eb) f(iles) d(ns) p(rocess-tree)\n");
+    printf("                 l(ibrary-load)\n");
+    printf("                 e.g. ramp:30:5000,burst:60:8000,steady:300:2000:rd\n");
+    printf("  --wait         wait for a keypress before exiting\n");
+    printf("  --help         show this help\n");
+    printf("\n");
+    printf("With no arguments the generator runs one pass per CPU and waits,\n");
+    printf("matching the original interactive demo behavior.\n");
+}
+
+// ---------------------------------------------------------------------------
+// Firehose mode: framed direct emission to the agent channel
+//
+// Every other engine pays real syscall cost per event, which caps the
+// rate we can present to the ingestion path. Firehose mode instead
+// writes pre-serialized telemetry frames straight to the agent-side
+// channel (a named pipe, or a VirtIO serial port path like \\.\COM2):
+// length-prefixed packed headers followed by a JSON body in the shape
+// the agent forwards upstream. A whole batch of frames is laid out
+// once in a preallocated arena at startup; per batch only the sequence
+// and timestamp fields are patched in place and the arena is handed to
+// a single WriteFile - no per-event serialization, no copies. This is
+// the ceiling test for Hyper-Bridge ingestion and the database write
+// path, decoupled from Windows syscall cost.
+// ---------------------------------------------------------------------------
+
+#define FIRE_BATCH 256
+
+#pragma pack(push, 1)
+typedef struct FireFrameHeader {
+    ULONG length;    // bytes that follow this field (header remainder + body)
+    USHORT type;     // LatClass of the simulated event
+    USHORT flags;
+    ULONGLONG seq;   // global event sequence
+    ULONGLONG qpc;   // emission timestamp, QueryPerformanceCounter ticks
+} FireFrameHeader;
+#pragma pack(pop)
+
+// One body template per event class, in the JSON shape the agent
+// forwards; contents are representative, the backend only has to parse
+const char* g_fireBodies[LAT_CLASS_COUNT] = {
+    "{\"channel\":\"registry\",\"op\":\"set\",\"path\":\"HKCU\\\\Software\\\\TelemetryTest\\\\churn_00\",\"value\":\"val_0000\"}",
+    "{\"channel\":\"file\",\"op\":\"create\",\"path\":\"C:\\\\Temp\\\\telemetry_churn_00\\\\churn_0.bin\",\"size\":4096}",
+    "{\"channel\":\"network\",\"op\":\"connect\",\"daddr\":\"93.184.216.34\",\"dport\":80,\"proto\":\"tcp\"}",
+    "{\"channel\":\"dns\",\"op\":\"query\",\"name\":\"example.com\",\"qtype\":\"A\"}",
+    "{\"channel\":\"object\",\"op\":\"mutex\",\"name\":\"Global\\\\TelemetryTestMutex\"}",
+    "{\"channel\":\"module\",\"op\":\"load\",\"path\":\"C:\\\\Windows\\\\System32\\\\version.dll\"}"
+};
+
+// Emit framed records until the requested count (or --duration) is
+// reached. Single-threaded by design: one channel, one writer, so
+// frames can never interleave mid-record.
+void RunFirehose() {
+    HANDLE channel = INVALID_HANDLE_VALUE;
+    char* arena;
+    size_t arenaLen = 0;
+    size_t seqOffsets[FIRE_BATCH];
+    size_t qpcOffsets[FIRE_BATCH];
+    ULONGLONG seq = 0;
+    ULONGLONG emitted = 0;
+    ULONGLONG target = (ULONGLONG)g_config.fireEvents;
+    ULONGLONG deadline = g_config.durationSec > 0
+                             ? GetTickCount64() + (ULONGLONG)g_config.durationSec * 1000
+                             : 0;
+
+    // A pipe server may not be up yet; retry for ~5 seconds
+    for (int attempt = 0; attempt < 50; attempt++) {
+        channel = CreateFileA(g_config.firehosePath, GENERIC_WRITE, 0, NULL,
+                              OPEN_EXISTING, 0, NULL);
+        if (channel != INVALID_HANDLE_VALUE) {
+            break;
+        }
+        if (GetLastError() == ERROR_PIPE_BUSY) {
+            WaitNamedPipeA(g_config.firehosePath, 100);
+        } else {
+            Sleep(100);
+        }
+    }
+    if (channel == INVALID_HANDLE_VALUE) {
+        printf("[-] Firehose: could not open channel %s (Error: %lu)\n",
+               g_config.firehosePath, GetLastError());
+        return;
+    }
+
+    // Lay the whole batch out once; record where the mutable fields live
+    size_t arenaCap = FIRE_BATCH * (sizeof(FireFrameHeader) + 160);
+    arena = (char*)malloc(arenaCap);
+    if (arena == NULL) {
+        CloseHandle(channel);
+        return;
+    }
+    for (int i = 0; i < FIRE_BATCH; i++) {
+        const char* body = g_fireBodies[i % LAT_CLASS_COUNT];
+        size_t bodyLen = strlen(body);
+        FireFrameHeader header;
+
+        header.length = (ULONG)(sizeof(FireFrameHeader) - sizeof(ULONG) + bodyLen);
+        header.type = (USHORT)(i % LAT_CLASS_COUNT);
+        header.flags = 0;
+        header.seq = 0;
+        header.qpc = 0;
+
+        seqOffsets[i] = arenaLen + offsetof(FireFrameHeader, seq);
+        qpcOffsets[i] = arenaLen + offsetof(FireFrameHeader, qpc);
+        memcpy(arena + arenaLen, &header, sizeof(header));
+        arenaLen += sizeof(header);
+        memcpy(arena + arenaLen, body, bodyLen);
+        arenaLen += bodyLen;
+    }
+
+    printf("[*] Firehose: streaming frames to %s\n", g_config.firehosePath);
+
+    while (!g_stop) {
+        if (deadline != 0) {
+            if (GetTickCount64() >= deadline) break;
+        } else if (emitted >= target) {
+            break;
+        }
+
+        // Patch sequence/timestamp in place; bodies never change
+        for (int i = 0; i < FIRE_BATCH; i++) {
+            RateWaitToken();
+            ULONGLONG now = LatNow();
+            seq++;
+            memcpy(arena + seqOffsets[i], &seq, sizeof(seq));
+            memcpy(arena + qpcOffsets[i], &now, sizeof(now));
+            CountEvent();
+        }
+
+        DWORD written;
+        if (!WriteFile(channel, arena, (DWORD)arenaLen, &written, NULL)) {
+            printf("[-] Firehose: write failed (Error: %lu), stopping\n",
+                   GetLastError());
+            break;
+        }
+        emitted += FIRE_BATCH;
+    }
+
+    free(arena);
+    CloseHandle(channel);
+    printf("[*] Firehose: emitted %llu frames\n",
+           (unsigned long long)emitted);
+}
+
+// ---------------------------------------------------------------------------
+// ETW provider mode: structured events through the kernel's trace path
+//
+// Firehose mode sizes the pipe/serial channel; this mode sizes the
+// agent's ETW consumer instead. The generator registers its own
+// provider and hammers EventWriteTransfer with pre-built descriptors -
+// one EVENT_DESCRIPTOR and one payload per event class, reusing the
+// firehose JSON bodies so the consumer sees the same shapes it gets
+// from its Sysmon-style sessions. EventWriteTransfer is a user-mode
+// copy into per-CPU session buffers, an order of magnitude cheaper
+// than the real registry/file/socket syscalls, so 100k+ events/sec is
+// reachable from a single thread and the consumer's buffer sizing and
+// flush cadence become the thing under test. Enable the provider GUID
+// below in the agent's trace session to receive the stream.
+// ---------------------------------------------------------------------------
+
+// {d7c5e1a2-4b0f-4c83-9a6e-31f08c2d5b77} - VoodooBox telemetry generator
+static const GUID g_etwProviderId =
+    { 0xd7c5e1a2, 0x4b0f, 0x4c83,
+      { 0x9a, 0x6e, 0x31, 0xf0, 0x8c, 0x2d, 0x5b, 0x77 } };
+
+void RunEtwMode() {
+    REGHANDLE provider = 0;
+    EVENT_DESCRIPTOR descs[LAT_CLASS_COUNT];
+    EVENT_DATA_DESCRIPTOR bodies[LAT_CLASS_COUNT];
+    ULONGLONG seq = 0;
+    ULONGLONG emitted = 0;
+    ULONGLONG failed = 0;
+    ULONGLONG target = (ULONGLONG)g_config.etwEvents;
+    ULONGLONG deadline = g_config.durationSec > 0
+                             ? GetTickCount64() + (ULONGLONG)g_config.durationSec * 1000
+                             : 0;
+
+    ULONG status = EventRegister(&g_etwProviderId, NULL, NULL, &provider);
+    if (status != ERROR_SUCCESS) {
+        printf("[-] ETW: EventRegister failed (Error: %lu)\n", status);
+        return;
+    }
+
+    // One descriptor per class: event ID is the class + 1 (IDs start at
+    // 1 by convention), keyword is a per-class bit so the session can
+    // filter, level 4 (informational) matches what the agent enables
+    for (int i = 0; i < LAT_CLASS_COUNT; i++) {
+        descs[i].Id = (USHORT)(i + 1);
+        descs[i].Version = 1;
+        descs[i].Channel = 0;
+        descs[i].Level = 4;
+        descs[i].Opcode = 0;
+        descs[i].Task = 0;
+        descs[i].Keyword = 1ULL << i;
+        EventDataDescCreate(&bodies[i], g_fireBodies[i],
+                            (ULONG)strlen(g_fireBodies[i]) + 1);
+    }
+
+    printf("[*] ETW: provider registered%s\n",
+           EventEnabled(provider, &descs[0]) ? " (session is listening)"
+                                             : " (no session enabled yet)");
+
+    while (!g_stop) {
+        if (deadline != 0) {
+            if (GetTickCount64() >= deadline) break;
+        } else if (emitted >= target) {
+            break;
+        }
+
+        RateWaitToken();
+        int cls = (int)(seq % LAT_CLASS_COUNT);
+        EVENT_DATA_DESCRIPTOR data[2];
+        EventDataDescCreate(&data[0], &seq, sizeof(seq));
+        data[1] = bodies[cls];
+        if (EventWriteTransfer(provider, &descs[cls], NULL, NULL,
+                               2, data) == ERROR_SUCCESS) {
+            emitted++;
+        } else {
+            failed++; // session buffers full: counted, never blocks
+        }
+        seq++;
+        CountEvent();
+    }
+
+    EventUnregister(provider);
+    printf("[*] ETW: wrote %llu events, %llu dropped at the session\n",
+           (unsigned long long)emitted, (unsigned long long)failed);
+}
+
+// Worker body: drives the full generator sequence concurrently with the
+// other workers, either for a fixed number of passes or until g_stop.
+DWORD WINAPI GeneratorWorker(LPVOID param) {
+    int workerId = (int)(INT_PTR)param;
+    int pass = 0;
+
+    if (g_config.affinity) {
+        PinWorkerThread(workerId);
+    }
+
+    while (!g_stop) {
+#ifdef TG_FORCED_MIX
+        const LONG mix = TG_FORCED_MIX; // baked: dispatch folds at compile time
+#else
+        LONG mix = g_phaseMix; // all bits set unless a profile is driving
+#endif
+
+        if (mix & MIX_MUTEX)    CreateTestMutex();
+        if (mix & MIX_REGISTRY) CreateRegistryEntries();
+        if (mix & MIX_WEB)      MakeWebRequests();
+        if (mix & MIX_FILES)    CreateFiles();
+        if (mix & MIX_DNS)      PerformDNSLookups();
+        if ((mix & MIX_MODULE) && g_config.dllOps > 0) {
+            RunDllEngine(g_config.dllOps);
+        }
+
+        // Process trees are heavyweight; one worker drives them so the
+        // spawn rate is set by depth/width, not the thread count
+        if (workerId == 0 && g_config.spawnDepth > 0 && (mix & MIX_SPAWN)) {
+            SpawnProcessTree(g_config.spawnDepth, g_config.spawnWidth);
+        }
+
+        pass++;
+        if (g_config.durationSec == 0 && pass >= g_config.loops) {
+            break;
+        }
+        // The token bucket already paces every operation when --eps or a
+        // profile is set; the legacy random inter-pass delay only applies
+        // unpaced.
+        if (g_config.eps <= 0 && g_profileCount == 0 && !g_config.findMax) {
+            SleepRandom();
+        }
+    }
+
+    ObjectEngineFlush();
+
+    (void)workerId;
+    return 0;
+}
+
+// Every telemetry-generating operation calls this once so the final
+// events/sec figure covers all workers.
+void CountEvent() {
+    LONGLONG seq = InterlockedIncrement64(&g_eventsEmitted);
+    if (g_traceFile != NULL) {
+        TraceEvent(seq);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Registry churn engine
+//
+// The registry hook is the agent's most expensive telemetry path, so
+// this phase has to be able to generate real volume. All key handles
+// (persistence keys plus a configurable fan-out of churn subkeys under
+// Software\TelemetryTest) are opened once at startup and cached for the
+// whole run; value names and data come from pools pre-generated at
+// init, so the hot loop is nothing but RegSetValueExA/RegDeleteValueA.
+// ---------------------------------------------------------------------------
+
+#define REG_MAX_FANOUT 32
+#define REG_NAME_POOL 256
+#define REG_DATA_SIZE 64
+
+HKEY g_regRunOnceKey = NULL;
+HKEY g_regRunKey = NULL;
+HKEY g_regCustomKey = NULL;
+HKEY g_regChurnKeys[REG_MAX_FANOUT];
+int g_regChurnCount = 0;
+char g_regNamePool[REG_NAME_POOL][16];
+BYTE g_regDataPool[REG_DATA_SIZE];
+volatile LONG g_regOpSeq = 0;
+
+// Open every key handle the run will need and pre-generate value
+// names/data. Called once from main() before the workers start.
+void InitRegistryEngine(int fanout) {
+    if (fanout < 1) fanout = 1;
+    if (fanout > REG_MAX_FANOUT) fanout = REG_MAX_FANOUT;
+
+    RegOpenKeyExA(HKEY_CURRENT_USER,
+                  "Software\\Microsoft\\Windows\\CurrentVersion\\RunOnce",
+                  0, KEY_WRITE, &g_regRunOnceKey);
+    RegOpenKeyExA(HKEY_CURRENT_USER,
+                  "Software\\Microsoft\\Windows\\CurrentVersion\\Run",
+                  0, KEY_WRITE, &g_regRunKey);
+    RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\TelemetryTest",
+                    0, NULL, REG_OPTION_NON_VOLATILE,
+                    KEY_WRITE, NULL, &g_regCustomKey, NULL);
+
+    for (int i = 0; i < fanout; i++) {
+        char subkey[64];
+        snprintf(subkey, sizeof(subkey), "Software\\TelemetryTest\\churn_%02d", i);
+        if (RegCreateKeyExA(HKEY_CURRENT_USER, subkey, 0, NULL,
+                            REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL,
+                            &g_regChurnKeys[g_regChurnCount], NULL) == ERROR_SUCCESS) {
+            g_regChurnCount++;
+        }
+    }
+
+    for (int i = 0; i < REG_NAME_POOL; i++) {
+        snprintf(g_regNamePool[i], sizeof(g_regNamePool[i]), "val_%04d", i);
+    }
+    for (int i = 0; i < REG_DATA_SIZE; i++) {
+        g_regDataPool[i] = (BYTE)TgRand(256);
+    }
+}
+
+void CloseRegistryEngine() {
+    if (g_regRunOnceKey) RegCloseKey(g_regRunOnceKey);
+    if (g_regRunKey) RegCloseKey(g_regRunKey);
+    if (g_regCustomKey) RegCloseKey(g_regCustomKey);
+    for (int i = 0; i < g_regChurnCount; i++) {
+        RegCloseKey(g_regChurnKeys[i]);
+    }
+    g_regRunOnceKey = g_regRunKey = g_regCustomKey = NULL;
+    g_regChurnCount = 0;
+}
+
+// Alternating set/delete churn across the cached subkey handles
+void RunRegistryEngine(int ops) {
+    int sets = 0, deletes = 0;
+
+    if (g_regChurnCount == 0 || ops <= 0) {
+        return;
+    }
+
+    for (int i = 0; i < ops && !g_stop; i++) {
+        RateWaitToken();
+        LONG seq = InterlockedIncrement(&g_regOpSeq);
+        HKEY key = g_regChurnKeys[seq % g_regChurnCount];
+        const char* name = g_regNamePool[seq % REG_NAME_POOL];
+
+        // Tagged runs trade the pre-generated name pool for joinability
+        char tagName[16];
+        LONG tag = SeqClaim();
+        if (tag) {
+            sprintf(tagName, "sq_%08lx", tag);
+            name = tagName;
+        }
+
+        ULONGLONG opStart = LatNow();
+        if (seq & 1) {
+            // Deleting a value that was never set still exercises the hook
+            RegDeleteValueA(key, name);
+            deletes++;
+        } else {
+            RegSetValueExA(key, name, 0, REG_BINARY,
+                           g_regDataPool, REG_DATA_SIZE);
+            sets++;
+        }
+        LatRecord(LAT_REGISTRY, opStart);
+        SeqStamp(tag);
+        CountEvent();
+    }
+
+    TgLog("  [+] Registry churn: %d sets, %d deletes across %d subkeys\n",
+           sets, deletes, g_regChurnCount);
+}
+
+void CreateRegistryEntries() {
+    char exePath[MAX_PATH];
+
+    // Get current executable path
+    GetModuleFileNameA(NULL, exePath, MAX_PATH);
+
+    // Persistence entries, written through the cached handles
+    RateWaitToken();
+    if (g_regRunOnceKey != NULL &&
+        RegSetValueExA(g_regRunOnceKey, "TelemetryTest", 0, REG_SZ,
+                       (BYTE*)exePath, (DWORD)strlen(exePath) + 1) == ERROR_SUCCESS) {
+        CountEvent();
+        TgLog("  [+] Created RunOnce registry entry\n");
+    } else {
+        TgLog("  [-] Failed to create RunOnce entry\n");
+    }
+
+    RateWaitToken();
+    if (g_regRunKey != NULL &&
+        RegSetValueExA(g_regRunKey, "TelemetryService", 0, REG_SZ,
+                       (BYTE*)exePath, (DWORD)strlen(exePath) + 1) == ERROR_SUCCESS) {
+        CountEvent();
+        TgLog("  [+] Created Run registry entry (Startup)\n");
+    } else {
+        TgLog("  [-] Failed to create Run entry\n");
+    }
+
+    if (g_regCustomKey != NULL) {
+        RateWaitToken();
+        DWORD installTime = (DWORD)time(NULL);
+        RegSetValueExA(g_regCustomKey, "InstallTime", 0, REG_DWORD,
+                       (BYTE*)&installTime, sizeof(DWORD));
+        CountEvent();
+        RegSetValueExA(g_regCustomKey, "Version", 0, REG_SZ,
+                       (BYTE*)"1.0.0", 6);
+        CountEvent();
+    }
+
+    // Bulk churn on top of the fixed persistence writes
+    RunRegistryEngine(g_config.regOps);
+}
+
+// ---------------------------------------------------------------------------
+// Memory-mapped target list
+//
+// The hardcoded 5-element url/domain arrays don't exercise anything at
+// realistic C2/DGA scale. A target file holds 100k+ hostnames in a
+// binary layout the engines can index with zero parse cost: a header,
+// a flat offset table, then the NUL-terminated strings. --build-targets
+// compiles a newline-delimited text list into this format offline;
+// --targets maps the result read-only at startup, so "loading" 100k
+// entries is one MapViewOfFile and startup stays detonation-fast.
+// ---------------------------------------------------------------------------
+
+#define TARGETS_MAGIC 0x4C544456UL  // "VDTL" little-endian
+#define TARGETS_VERSION 1
+#define TARGETS_MAX_NAME 253        // longest legal hostname
+
+#pragma pack(push, 1)
+typedef struct TargetFileHeader {
+    ULONG magic;
+    ULONG version;
+    ULONG count;
+    ULONG reserved;
+} TargetFileHeader;
+#pragma pack(pop)
+
+const BYTE* g_targetView = NULL;
+const ULONG* g_targetOffsets = NULL;  // file-relative string offsets
+ULONG g_targetCount = 0;
+
+// Index an entry in place: no copy, no allocation, no strlen.
+const char* TargetName(ULONG idx) {
+    return (const char*)(g_targetView + g_targetOffsets[idx]);
+}
+
+// Offline compiler: text list in, mapped format out. Runs once per list
+// on the build box, never in the detonation path, so plain stdio is fine.
+int TargetsBuild(const char* inPath, const char* outPath) {
+    FILE* in = fopen(inPath, "r");
+    if (in == NULL) {
+        printf("[-] Targets: cannot open %s\n", inPath);
+        return 0;
+    }
+
+    // Pass 1: count entries and total string bytes
+    char line[512];
+    ULONG count = 0;
+    ULONG blobBytes = 0;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        size_t len = strcspn(line, "\r\n");
+        if (len == 0) continue;
+        if (len > TARGETS_MAX_NAME) {
+            printf("[-] Targets: entry %lu longer than %d chars\n",
+                   count + 1, TARGETS_MAX_NAME);
+            fclose(in);
+            return 0;
+        }
+        count++;
+        blobBytes += (ULONG)len + 1;
+    }
+    if (count == 0) {
+        printf("[-] Targets: %s has no entries\n", inPath);
+        fclose(in);
+        return 0;
+    }
+
+    FILE* out = fopen(outPath, "wb");
+    if (out == NULL) {
+        printf("[-] Targets: cannot create %s\n", outPath);
+        fclose(in);
+        return 0;
+    }
+
+    TargetFileHeader hdr;
+    hdr.magic = TARGETS_MAGIC;
+    hdr.version = TARGETS_VERSION;
+    hdr.count = count;
+    hdr.reserved = 0;
+    fwrite(&hdr, sizeof(hdr), 1, out);
+
+    // Pass 2: offsets first, strings behind them
+    ULONG stringsAt = (ULONG)sizeof(hdr) + count * (ULONG)sizeof(ULONG);
+    ULONG offset = stringsAt;
+    rewind(in);
+    while (fgets(line, sizeof(line), in) != NULL) {
+        size_t len = strcspn(line, "\r\n");
+        if (len == 0) continue;
+        fwrite(&offset, sizeof(offset), 1, out);
+        offset += (ULONG)len + 1;
+    }
+    rewind(in);
+    while (fgets(line, sizeof(line), in) != NULL) {
+        size_t len = strcspn(line, "\r\n");
+        if (len == 0) continue;
+        line[len] = '\0';
+        fwrite(line, len + 1, 1, out);
+    }
+
+    fclose(in);
+    fclose(out);
+    printf("[+] Targets: wrote %lu entries (%lu bytes of strings) to %s\n",
+           count, blobBytes, outPath);
+    return 1;
+}
+
+// Map a built target file read-only and point the index at it. The view
+// stays mapped for the life of the process.
+int TargetsLoad(const char* path) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        printf("[-] Targets: cannot open %s (Error: %lu)\n",
+               path, GetLastError());
+        return 0;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) ||
+        size.QuadPart < (LONGLONG)sizeof(TargetFileHeader)) {
+        printf("[-] Targets: %s is truncated\n", path);
+        CloseHandle(file);
+        return 0;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file); // the mapping keeps the file alive
+    if (mapping == NULL) {
+        printf("[-] Targets: mapping failed (Error: %lu)\n", GetLastError());
+        return 0;
+    }
+
+    const BYTE* view = (const BYTE*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping); // the view keeps the mapping alive
+    if (view == NULL) {
+        printf("[-] Targets: MapViewOfFile failed (Error: %lu)\n", GetLastError());
+        return 0;
+    }
+
+    const TargetFileHeader* hdr = (const TargetFileHeader*)view;
+    if (hdr->magic != TARGETS_MAGIC || hdr->version != TARGETS_VERSION ||
+        hdr->count == 0) {
+        printf("[-] Targets: %s is not a target file (run --build-targets)\n",
+               path);
+        UnmapViewOfFile(view);
+        return 0;
+    }
+
+    // The header alone proves nothing about the rest of the file; the
+    // engines index the table with no per-lookup checks, so a truncated
+    // or corrupt file has to be rejected here, not discovered as an
+    // access violation mid-run.
+    ULONGLONG fileSize = (ULONGLONG)size.QuadPart;
+    ULONGLONG tableEnd = sizeof(TargetFileHeader) +
+                         (ULONGLONG)hdr->count * sizeof(ULONG);
+    if (fileSize < tableEnd || view[fileSize - 1] != '\0') {
+        printf("[-] Targets: %s is truncated\n", path);
+        UnmapViewOfFile(view);
+        return 0;
+    }
+    const ULONG* offsets = (const ULONG*)(view + sizeof(TargetFileHeader));
+    for (ULONG i = 0; i < hdr->count; i++) {
+        if (offsets[i] < tableEnd || offsets[i] >= fileSize) {
+            printf("[-] Targets: %s has a bad offset at entry %lu\n", path, i);
+            UnmapViewOfFile(view);
+            return 0;
+        }
+        // Consumers size their request and packet buffers for hostnames
+        if (strlen((const char*)view + offsets[i]) > TARGETS_MAX_NAME) {
+            printf("[-] Targets: %s entry %lu longer than %d chars\n",
+                   path, i, TARGETS_MAX_NAME);
+            UnmapViewOfFile(view);
+            return 0;
+        }
+    }
+
+    g_targetView = view;
+    g_targetOffsets = offsets;
+    g_targetCount = hdr->count;
+    printf("[*] Targets: mapped %lu entries from %s\n", g_targetCount, path);
+    return 1;
+}
+
+// ---------------------------------------------------------------------------
+// HTTP beacon engine
+//
+// Replaces the old WinINet path, which paid full session setup/teardown
+// per URL and blocked on every request. Targets are resolved once at
+// startup; each worker then drives a small pool of non-blocking sockets
+// through a connect/send/read state machine with HTTP keep-alive, so
+// connections are reused across beacons instead of re-opened.
+// ---------------------------------------------------------------------------
+
+#define BEACON_MAX_POOL 32
+
+typedef struct BeaconTarget {
+    const char* host;    // Host header / DNS name
+    const char* path;    // request path
+    ULONG addr;          // resolved IPv4 address, network byte order
+    int resolved;
+} BeaconTarget;
+
+BeaconTarget g_beaconTargets[] = {
+    { "example.com",         "/c2/beacon", 0, 0 },
+    { "httpbin.org",         "/get",       0, 0 },
+    { "www.google.com",      "/",          0, 0 },
+    { "api.ipify.org",       "/",          0, 0 },
+    { "checkip.amazonaws.com", "/",        0, 0 }
+};
+
+int g_numBeaconTargets = sizeof(g_beaconTargets) / sizeof(g_beaconTargets[0]);
+int g_resolvedBeaconTargets = 0;
+
+typedef enum BeaconState {
+    BC_IDLE,        // no socket, ready to connect
+    BC_CONNECTING,  // non-blocking connect in flight
+    BC_SENDING,     // request (partially) unsent
+    BC_READING      // waiting for / draining the response
+} BeaconState;
+
+typedef struct BeaconConn {
+    SOCKET s;
+    BeaconState state;
+    int target;          // index into g_beaconTargets
+    ULONGLONG connectStart; // QPC when the non-blocking connect began
+    char request[512];
+    int reqLen;
+    int reqSent;
+    char response[4096];
+    int respLen;         // bytes accumulated while hunting for header end
+    long bodyRemaining;  // -1 until Content-Length is known
+    int reusable;        // keep-alive possible for the current exchange
+} BeaconConn;
+
+// Resolve every beacon target up front. Returns the number of usable targets.
+int InitBeaconTargets() {
+    g_resolvedBeaconTargets = 0;
+    for (int i = 0; i < g_numBeaconTargets; i++) {
+        struct hostent* host = gethostbyname(g_beaconTargets[i].host);
+        if (host != NULL && host->h_addr_list[0] != NULL) {
+            g_beaconTargets[i].addr = *(u_long*)host->h_addr_list[0];
+            g_beaconTargets[i].resolved = 1;
+            g_resolvedBeaconTargets++;
+        } else {
+            TgLog("  [-] Could not resolve beacon target: %s\n",
+                   g_beaconTargets[i].host);
+        }
+    }
+    return g_resolvedBeaconTargets;
+}
+
+// Begin a non-blocking connect for one pool slot
+static int BeaconStartConnect(BeaconConn* conn) {
+    BeaconTarget* target = &g_beaconTargets[conn->target];
+    struct sockaddr_in sa;
+
+    conn->s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (conn->s == INVALID_SOCKET) {
+        return 0;
+    }
+
+    u_long nonBlocking = 1;
+    ioctlsocket(conn->s, FIONBIO, &nonBlocking);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(80);
+    sa.sin_addr.s_addr = target->addr;
+
+    if (connect(conn->s, (struct sockaddr*)&sa, sizeof(sa)) == SOCKET_ERROR &&
+        WSAGetLastError() != WSAEWOULDBLOCK) {
+        closesocket(conn->s);
+        conn->s = INVALID_SOCKET;
+        return 0;
+    }
+
+    conn->connectStart = LatNow();
+    conn->state = BC_CONNECTING;
+    return 1;
+}
+
+// Queue the next beacon request on an established (or reused) connection
+static void BeaconPrepareRequest(BeaconConn* conn) {
+    BeaconTarget* target = &g_beaconTargets[conn->target];
+    // With a mapped target list, rotate the Host header through it so
+    // the agent's HTTP telemetry sees hostname variety at scale (the
+    // sockets still go to the resolved beacon IPs)
+    const char* hostName = g_targetCount > 0
+        ? TargetName((ULONG)TgRand(g_targetCount))
+        : target->host;
+    conn->reqLen = snprintf(conn->request, sizeof(conn->request),
+                            "GET %s HTTP/1.1\r\n"
+                            "Host: %s\r\n"
+                            "User-Agent: TelemetryBot/1.0\r\n"
+                            "Connection: keep-alive\r\n"
+                            "\r\n",
+                            target->path, hostName);
+    if (conn->reqLen >= (int)sizeof(conn->request)) {
+        conn->reqLen = (int)sizeof(conn->request) - 1; // snprintf truncated
+    }
+    conn->reqSent = 0;
+    conn->respLen = 0;
+    conn->bodyRemaining = -1;
+    conn->reusable = 0;
+    conn->state = BC_SENDING;
+}
+
+static void BeaconClose(BeaconConn* conn) {
+    if (conn->s != INVALID_SOCKET) {
+        closesocket(conn->s);
+        conn->s = INVALID_SOCKET;
+    }
+    conn->state = BC_IDLE;
+}
+
+// Scan accumulated response bytes for the end of the headers and pick out
+// Content-Length, so keep-alive connections drain exactly one response.
+static void BeaconParseHeaders(BeaconConn* conn) {
+    conn->response[conn->respLen] = '\0';
+    char* headerEnd = strstr(conn->response, "\r\n\r\n");
+    if (headerEnd == NULL) {
+        return; // headers incomplete, keep reading
+    }
+
+    char* lengthHdr = strstr(conn->response, "Content-Length:");
+    if (lengthHdr != NULL && lengthHdr < headerEnd) {
+        long contentLength = atol(lengthHdr + 15);
+        long bodySeen = conn->respLen - (long)(headerEnd + 4 - conn->response);
+        conn->bodyRemaining = contentLength - bodySeen;
+        if (conn->bodyRemaining < 0) {
+            conn->bodyRemaining = 0;
+        }
+        conn->reusable = 1;
+    } else {
+        // No Content-Length (chunked or close-delimited): don't try to
+        // reuse this connection, just read until the server closes it.
+        conn->bodyRemaining = -1;
+        conn->reusable = 0;
+    }
+}
+
+// Drive up to poolSize pooled connections until totalRequests beacons have
+// completed (or failed). Runs entirely on the calling worker thread.
+void RunBeaconEngine(int totalRequests, int poolSize) {
+    BeaconConn pool[BEACON_MAX_POOL];
+    int completed = 0, failed = 0, started = 0;
+
+    if (g_resolvedBeaconTargets == 0 || totalRequests <= 0) {
+        return;
+    }
+    if (poolSize < 1) poolSize = 1;
+    if (poolSize > BEACON_MAX_POOL) poolSize = BEACON_MAX_POOL;
+    if (poolSize > totalRequests) poolSize = totalRequests;
+
+    memset(pool, 0, sizeof(pool));
+    for (int i = 0; i < poolSize; i++) {
+        pool[i].s = INVALID_SOCKET;
+        pool[i].state = BC_IDLE;
+        // Spread the pool across resolved targets
+        pool[i].target = i % g_numBeaconTargets;
+        while (!g_beaconTargets[pool[i].target].resolved) {
+            pool[i].target = (pool[i].target + 1) % g_numBeaconTargets;
+        }
+    }
+
+    while (completed + failed < totalRequests && !g_stop) {
+        fd_set readSet, writeSet, exceptSet;
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        FD_ZERO(&exceptSet);
+        SOCKET maxSocket = 0;
+        int pending = 0;
+
+        for (int i = 0; i < poolSize; i++) {
+            BeaconConn* conn = &pool[i];
+
+            if (conn->state == BC_IDLE) {
+                if (started >= totalRequests) {
+                    continue; // nothing left to hand out
+                }
+                RateWaitToken();
+                if (!BeaconStartConnect(conn)) {
+                    failed++;
+                    CountEvent(); // the connect attempt is still telemetry
+                    continue;
+                }
+                started++;
+            }
+
+            if (conn->state == BC_CONNECTING || conn->state == BC_SENDING) {
+                FD_SET(conn->s, &writeSet);
+                if (conn->state == BC_CONNECTING) {
+                    // Winsock reports a failed non-blocking connect only
+                    // through the except set; it never becomes writable
+                    FD_SET(conn->s, &exceptSet);
+                }
+            } else if (conn->state == BC_READING) {
+                FD_SET(conn->s, &readSet);
+            }
+            if (conn->s > maxSocket) maxSocket = conn->s;
+            pending++;
+        }
+
+        if (pending == 0) {
+            break; // everything handed out and finished
+        }
+
+        struct timeval tv = { 1, 0 };
+        int ready = select((int)maxSocket + 1, &readSet, &writeSet, &exceptSet, &tv);
+        if (ready == SOCKET_ERROR) {
+            break;
+        }
+        if (ready == 0) {
+            // A full second with no progress: fail the in-flight beacons
+            // rather than hanging the whole pass in an offline sandbox.
+            for (int i = 0; i < poolSize; i++) {
+                if (pool[i].state != BC_IDLE) {
+                    BeaconClose(&pool[i]);
+                    failed++;
+                    CountEvent();
+                }
+            }
+            continue;
+        }
+
+        for (int i = 0; i < poolSize; i++) {
+            BeaconConn* conn = &pool[i];
+
+            if (conn->state == BC_CONNECTING && FD_ISSET(conn->s, &exceptSet)) {
+                // Refused or unreachable: fail just this slot, not the
+                // pool; healthy connections keep their sockets
+                BeaconClose(conn);
+                failed++;
+                CountEvent();
+                continue;
+            }
+
+            if (conn->state == BC_CONNECTING && FD_ISSET(conn->s, &writeSet)) {
+                LatRecord(LAT_NETWORK, conn->connectStart);
+                BeaconPrepareRequest(conn);
+            }
+
+            if (conn->state == BC_SENDING && FD_ISSET(conn->s, &writeSet)) {
+                int sent = send(conn->s, conn->request + conn->reqSent,
+                                conn->reqLen - conn->reqSent, 0);
+                if (sent == SOCKET_ERROR) {
+                    if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                        BeaconClose(conn);
+                        failed++;
+                        CountEvent();
+                    }
+                    continue;
+                }
+                conn->reqSent += sent;
+                if (conn->reqSent >= conn->reqLen) {
+                    conn->state = BC_READING;
+                }
+            }
+
+            if (conn->state == BC_READING && FD_ISSET(conn->s, &readSet)) {
+                char buffer[4096];
+                int space = (int)sizeof(conn->response) - conn->respLen - 1;
+                int received;
+
+                if (conn->bodyRemaining == -1 && space > 0) {
+                    // Still hunting for the end of the headers
+                    received = recv(conn->s, conn->response + conn->respLen,
+                                    space, 0);
+                    if (received > 0) {
+                        conn->respLen += received;
+                        BeaconParseHeaders(conn);
+                    }
+                } else {
+                    // Headers done (or overflowed): just drain the body
+                    received = recv(conn->s, buffer, sizeof(buffer), 0);
+                    if (received > 0 && conn->bodyRemaining > 0) {
+                        conn->bodyRemaining -= received;
+                        if (conn->bodyRemaining < 0) conn->bodyRemaining = 0;
+                    }
+                }
+
+                if (received == 0 ||
+                    (received == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK)) {
+                    // Server closed (normal for close-delimited responses)
+                    if (conn->respLen > 0) {
+                        completed++;
+                    } else {
+                        failed++;
+                    }
+                    CountEvent();
+                    BeaconClose(conn);
+                } else if (conn->reusable && conn->bodyRemaining == 0) {
+                    // Full response drained - recycle the connection
+                    completed++;
+                    CountEvent();
+                    if (started < totalRequests) {
+                        RateWaitToken();
+                        BeaconPrepareRequest(conn);
+                        started++;
+                    } else {
+                        BeaconClose(conn);
+                    }
+                }
+            }
+        }
+    }
+
+    // Tear down anything still in flight
+    for (int i = 0; i < poolSize; i++) {
+        BeaconClose(&pool[i]);
+    }
+
+    TgLog("  [+] Beacon engine: %d ok, %d failed (%d pooled connections)\n",
+           completed, failed, poolSize);
+}
+
+void MakeWebRequests() {
+    RunBeaconEngine(g_config.beacons, g_config.httpPool);
+    if (g_config.xferOps > 0) {
+        RunTransferEngine(g_config.xferOps);
+    }
+    if (g_config.connOps > 0) {
+        RunConnEngine(g_config.connOps);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TCP connect/close churn engine
+//
+// Per-connection telemetry cost dominates production traces, and none
+// of the other network engines isolates it: beacons and transfers do
+// real I/O on their connections. This one does nothing but the
+// connect/close cycle, as fast as the stack allows: a window of
+// non-blocking connects in flight at once (the same select() state
+// machine the beacon and DNS engines use), and a hard SO_LINGER(0)
+// close on completion so churned ports don't pile up in TIME_WAIT and
+// throttle the cycle rate.
+// ---------------------------------------------------------------------------
+
+#define CONN_MAX_TARGETS 8
+#define CONN_WINDOW 64
+#define CONN_TIMEOUT_MS 1000
+
+struct sockaddr_in g_connTargets[CONN_MAX_TARGETS];
+int g_connTargetCount = 0;
+
+// Parse the comma-separated host:port list once at startup
+int InitConnEngine() {
+    char listBuf[256];
+    strncpy(listBuf, g_config.connServer, sizeof(listBuf) - 1);
+    listBuf[sizeof(listBuf) - 1] = '\0';
+
+    g_connTargetCount = 0;
+    char* entry = strtok(listBuf, ",");
+    while (entry != NULL && g_connTargetCount < CONN_MAX_TARGETS) {
+        char* colon = strchr(entry, ':');
+        int port = 9;
+        if (colon != NULL) {
+            *colon = '\0';
+            port = atoi(colon + 1);
+        }
+        if (port <= 0 || port > 65535) {
+            return 0;
+        }
+
+        ULONG addr = inet_addr(entry);
+        if (addr == INADDR_NONE) {
+            struct hostent* host = gethostbyname(entry);
+            if (host == NULL || host->h_addr_list[0] == NULL) {
+                return 0;
+            }
+            addr = *(u_long*)host->h_addr_list[0];
+        }
+
+        struct sockaddr_in* sa = &g_connTargets[g_connTargetCount++];
+        memset(sa, 0, sizeof(*sa));
+        sa->sin_family = AF_INET;
+        sa->sin_port = htons((USHORT)port);
+        sa->sin_addr.s_addr = addr;
+
+        entry = strtok(NULL, ",");
+    }
+    return g_connTargetCount > 0;
+}
+
+// Drive `cycles` connect/close round trips through a fixed in-flight
+// window. A refused connect still completes the cycle - the agent sees
+// the SYN either way, which is the telemetry we're generating.
+void RunConnEngine(int cycles) {
+    SOCKET window[CONN_WINDOW];
+    ULONGLONG startQpc[CONN_WINDOW];
+    int completed = 0, started = 0;
+
+    for (int i = 0; i < CONN_WINDOW; i++) {
+        window[i] = INVALID_SOCKET;
+    }
+
+    while (completed < cycles && !g_stop) {
+        // Top up the in-flight window
+        for (int i = 0; i < CONN_WINDOW && started < cycles; i++) {
+            if (window[i] != INVALID_SOCKET) {
+                continue;
+            }
+            RateWaitToken();
+
+            SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if (s == INVALID_SOCKET) {
+                completed++;
+                started++;
+                continue;
+            }
+            u_long nonBlocking = 1;
+            ioctlsocket(s, FIONBIO, &nonBlocking);
+
+            // Hard close on completion: no FIN handshake, no TIME_WAIT
+            struct linger hardClose = { 1, 0 };
+            setsockopt(s, SOL_SOCKET, SO_LINGER,
+                       (const char*)&hardClose, sizeof(hardClose));
+
+            struct sockaddr_in* sa =
+                &g_connTargets[started % g_connTargetCount];
+            if (connect(s, (struct sockaddr*)sa, sizeof(*sa)) == SOCKET_ERROR &&
+                WSAGetLastError() != WSAEWOULDBLOCK) {
+                closesocket(s);
+                completed++;
+                started++;
+                CountEvent();
+                continue;
+            }
+            window[i] = s;
+            startQpc[i] = LatNow();
+            started++;
+        }
+
+        fd_set writeSet, exceptSet;
+        FD_ZERO(&writeSet);
+        FD_ZERO(&exceptSet);
+        SOCKET maxSocket = 0;
+        int pending = 0;
+        for (int i = 0; i < CONN_WINDOW; i++) {
+            if (window[i] == INVALID_SOCKET) {
+                continue;
+            }
+            FD_SET(window[i], &writeSet);
+            FD_SET(window[i], &exceptSet);
+            if (window[i] > maxSocket) maxSocket = window[i];
+            pending++;
+        }
+        if (pending == 0) {
+            break;
+        }
+
+        struct timeval tv = { CONN_TIMEOUT_MS / 1000,
+                              (CONN_TIMEOUT_MS % 1000) * 1000 };
+        int ready = select((int)maxSocket + 1, NULL, &writeSet, &exceptSet, &tv);
+        if (ready == SOCKET_ERROR) {
+            break;
+        }
+        if (ready == 0) {
+            // Stack saturated or target gone: recycle the whole window
+            for (int i = 0; i < CONN_WINDOW; i++) {
+                if (window[i] != INVALID_SOCKET) {
+                    closesocket(window[i]);
+                    window[i] = INVALID_SOCKET;
+                    completed++;
+                    CountEvent();
+                }
+            }
+            continue;
+        }
+
+        for (int i = 0; i < CONN_WINDOW; i++) {
+            if (window[i] == INVALID_SOCKET) {
+                continue;
+            }
+            if (FD_ISSET(window[i], &writeSet) ||
+                FD_ISSET(window[i], &exceptSet)) {
+                LatRecord(LAT_NETWORK, startQpc[i]);
+                closesocket(window[i]); // hard close, see SO_LINGER above
+                window[i] = INVALID_SOCKET;
+                completed++;
+                CountEvent();
+            }
+        }
+    }
+
+    TgLog("  [+] Conn churn: %d connect/close cycles\n", completed);
+}
+
+// ---------------------------------------------------------------------------
+// Sequence tagging and the shared emission table
+//
+// Whether the pipeline drops events under load is unanswerable unless
+// every artifact can be joined back to the moment it was emitted. With
+// --seq-table, artifact names carry a claimed sequence tag (registry
+// value names, file names, DNS labels, object names) and the emission
+// QPC timestamp for each tag is published into a fixed-name shared
+// section. The harness maps the same section, joins tags extracted from
+// backend ingestion records against the table, and gets loss rate and
+// end-to-end latency per event class instead of a guess. Slots recycle
+// modulo the table size, so the harness must drain faster than 1M
+// events behind - which it always is unless things are already on fire.
+// ---------------------------------------------------------------------------
+
+#define SEQ_TABLE_NAME "Local\\VoodooBoxSeqTable"
+#define SEQ_TABLE_MAGIC 0x51455356UL  // "VSEQ" little-endian
+#define SEQ_TABLE_CAP (1 << 20)       // slots; power of two
+
+#pragma pack(push, 1)
+typedef struct SeqTableHeader {
+    ULONG magic;
+    ULONG version;
+    ULONG capacity;
+    ULONG reserved;
+    ULONGLONG perfFreq;      // so the harness can convert QPC to ns
+    volatile LONG lastSeq;   // highest tag claimed so far
+    volatile LONG ingested;  // fed back by the harness: tags seen end-to-end
+} SeqTableHeader;
+#pragma pack(pop)
+
+SeqTableHeader* g_seqTable = NULL;
+volatile ULONGLONG* g_seqStamps = NULL; // QPC per tag, indexed modulo cap
+
+int SeqTableInit() {
+    HANDLE shm = CreateFileMappingA(
+        INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0,
+        sizeof(SeqTableHeader) + SEQ_TABLE_CAP * sizeof(ULONGLONG),
+        SEQ_TABLE_NAME);
+    if (shm == NULL) {
+        return 0;
+    }
+    g_seqTable = (SeqTableHeader*)MapViewOfFile(shm, FILE_MAP_ALL_ACCESS,
+                                                0, 0, 0);
+    CloseHandle(shm); // the view keeps the section alive
+    if (g_seqTable == NULL) {
+        return 0;
+    }
+
+    g_seqTable->magic = SEQ_TABLE_MAGIC;
+    g_seqTable->version = 1;
+    g_seqTable->capacity = SEQ_TABLE_CAP;
+    g_seqTable->reserved = 0;
+    g_seqTable->perfFreq = (ULONGLONG)g_perfFreq.QuadPart;
+    g_seqTable->lastSeq = 0;
+    g_seqTable->ingested = 0;
+    g_seqStamps = (volatile ULONGLONG*)(g_seqTable + 1);
+
+    printf("[*] Sequence table: %s, %d slots\n", SEQ_TABLE_NAME, SEQ_TABLE_CAP);
+    return 1;
+}
+
+// Claim the next tag for an artifact about to be created. Returns 0
+// when tagging is off, so call sites can keep their untagged fast path.
+LONG SeqClaim() {
+    if (g_seqTable == NULL) {
+        return 0;
+    }
+    return InterlockedIncrement(&g_seqTable->lastSeq);
+}
+
+// Publish the emission timestamp for a claimed tag. Called right after
+// the operation that put the tag on the wire / disk / registry.
+void SeqStamp(LONG tag) {
+    if (g_seqStamps != NULL && tag > 0) {
+        g_seqStamps[(ULONG)tag & (SEQ_TABLE_CAP - 1)] = LatNow();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Adaptive rate controller
+//
+// Finding the agent's breaking point used to mean re-running at guessed
+// intensities. --find-max closes the loop instead: the harness feeds
+// its count of end-to-end ingested tags back through the sequence
+// table's `ingested` field, the controller holds each candidate rate
+// for a measurement window and compares what we claimed against what
+// arrived. It ramps the rate geometrically until the loss fraction
+// crosses the threshold, then binary-searches between the last clean
+// and first dirty rate, and prints the maximum sustainable events/sec.
+// One unattended run replaces an afternoon of bisecting by hand.
+// ---------------------------------------------------------------------------
+
+#define CTRL_START_EPS 500
+#define CTRL_WINDOW_MS 2000
+#define CTRL_SETTLE_MS 500       // let queues drain after a rate change
+#define CTRL_LOSS_LIMIT 0.05     // >5% of a window lost = unsustainable
+#define CTRL_MIN_GAP 0.05        // stop when the search range is this tight
+
+// Hold `eps` for one window and return the observed loss fraction.
+static double CtrlMeasureWindow(int eps) {
+    RateSetEps((double)eps);
+    Sleep(CTRL_SETTLE_MS);
+
+    LONG claimed0 = g_seqTable->lastSeq;
+    LONG ingested0 = g_seqTable->ingested;
+    Sleep(CTRL_WINDOW_MS);
+    LONG emitted = g_seqTable->lastSeq - claimed0;
+    LONG arrived = g_seqTable->ingested - ingested0;
+
+    if (emitted <= 0) {
+        return 0.0;
+    }
+    if (arrived > emitted) {
+        arrived = emitted; // harness caught up on an earlier backlog
+    }
+    double loss = (double)(emitted - arrived) / (double)emitted;
+    TgLog("[*] Controller: %d eps -> %ld emitted, %ld ingested (%.1f%% loss)\n",
+          eps, emitted, arrived, loss * 100.0);
+    return loss;
+}
+
+void RunAdaptiveController() {
+    int goodEps = 0;
+    int badEps = 0;
+    int eps = CTRL_START_EPS;
+
+    TgLog("[*] Controller: searching for max sustainable rate...\n");
+
+    // Phase 1: geometric ramp until the pipeline starts losing events
+    while (!g_stop) {
+        if (CtrlMeasureWindow(eps) <= CTRL_LOSS_LIMIT) {
+            goodEps = eps;
+            eps *= 2;
+        } else {
+            badEps = eps;
+            break;
+        }
+    }
+
+    // Phase 2: binary search between the last clean and first dirty rate
+    while (!g_stop && badEps > 0 &&
+           (double)(badEps - goodEps) / badEps > CTRL_MIN_GAP) {
+        eps = goodEps + (badEps - goodEps) / 2;
+        if (CtrlMeasureWindow(eps) <= CTRL_LOSS_LIMIT) {
+            goodEps = eps;
+        } else {
+            badEps = eps;
+        }
+    }
+
+    TgLog("[+] Max sustainable rate: %d events/sec (loss threshold %.0f%%)\n",
+          goodEps, CTRL_LOSS_LIMIT * 100.0);
+}
+
+// ---------------------------------------------------------------------------
+// HTTP transfer engine
+//
+// The beacon engine covers thousands of tiny exchanges; this one covers
+// the other end of the distribution. Each transfer POSTs a body of
+// --xfer-min..--xfer-max KB to a local echo server and streams the
+// echoed response back to completion, so the agent's network path sees
+// multi-megabyte flows, not just beacon-sized ones. Receive buffers
+// come from a shared pool of 64KB blocks acquired per transfer and
+// returned when it finishes - no per-read allocation, and read sizes
+// that match what a real downloader would use instead of 4KB nibbles.
+// ---------------------------------------------------------------------------
+
+#define XFER_BUF_SIZE (64 * 1024)
+#define XFER_POOL_BUFS 64
+#define XFER_IO_TIMEOUT_MS 1000
+
+char g_xferBufs[XFER_POOL_BUFS][XFER_BUF_SIZE];
+volatile LONG g_xferBufUsed[XFER_POOL_BUFS];
+char g_xferPayload[XFER_BUF_SIZE]; // shared send pattern, filled at init
+ULONG g_xferAddr = 0;              // echo server, network byte order
+USHORT g_xferPort = 0;
+
+static char* XferAcquireBuf(int* idx) {
+    for (;;) {
+        for (int i = 0; i < XFER_POOL_BUFS; i++) {
+            if (g_xferBufUsed[i] == 0 &&
+                InterlockedCompareExchange(&g_xferBufUsed[i], 1, 0) == 0) {
+                *idx = i;
+                return g_xferBufs[i];
+            }
+        }
+        if (g_stop) {
+            *idx = -1;
+            return NULL;
+        }
+        Sleep(1); // every buffer in flight; transfers ahead of us will free one
+    }
+}
+
+static void XferReleaseBuf(int idx) {
+    if (idx >= 0) {
+        InterlockedExchange(&g_xferBufUsed[idx], 0);
+    }
+}
+
+// Parse --xfer-server and build the send pattern. Returns 0 on a bad
+// address so the caller can disable the engine rather than loop on it.
+int InitXferEngine() {
+    char hostBuf[128];
+    strncpy(hostBuf, g_config.xferServer, sizeof(hostBuf) - 1);
+    hostBuf[sizeof(hostBuf) - 1] = '\0';
+
+    char* colon = strchr(hostBuf, ':');
+    int port = 8080;
+    if (colon != NULL) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+    }
+    if (port <= 0 || port > 65535) {
+        return 0;
+    }
+
+    g_xferAddr = inet_addr(hostBuf);
+    if (g_xferAddr == INADDR_NONE) {
+        struct hostent* host = gethostbyname(hostBuf);
+        if (host == NULL || host->h_addr_list[0] == NULL) {
+            return 0;
+        }
+        g_xferAddr = *(u_long*)host->h_addr_list[0];
+    }
+    g_xferPort = htons((USHORT)port);
+
+    for (int i = 0; i < XFER_BUF_SIZE; i++) {
+        g_xferPayload[i] = (char)('A' + (i % 26));
+    }
+
+    if (g_config.xferMinKb < 1) g_config.xferMinKb = 1;
+    if (g_config.xferMaxKb < g_config.xferMinKb) {
+        g_config.xferMaxKb = g_config.xferMinKb;
+    }
+    return 1;
+}
+
+// One transfer at a time per worker: connect, stream the body out from
+// the shared pattern, stream the echo back through a pooled buffer.
+// Large flows are about sustained bytes, not connection concurrency -
+// the beacon engine already covers that axis.
+void RunTransferEngine(int transfers) {
+    for (int t = 0; t < transfers && !g_stop; t++) {
+        RateWaitToken();
+
+        int sizeKb = g_config.xferMinKb +
+                     (int)TgRand(g_config.xferMaxKb - g_config.xferMinKb + 1);
+        long bodyBytes = (long)sizeKb * 1024;
+
+        SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (s == INVALID_SOCKET) {
+            continue;
+        }
+
+        struct sockaddr_in sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sin_family = AF_INET;
+        sa.sin_port = g_xferPort;
+        sa.sin_addr.s_addr = g_xferAddr;
+
+        // Blocking by design (one transfer at a time), but a stalled
+        // server has to cost a failed cycle, not a wedged run: cap
+        // every send/recv so the worker always gets back to g_stop
+        DWORD ioTimeout = XFER_IO_TIMEOUT_MS;
+        setsockopt(s, SOL_SOCKET, SO_SNDTIMEO,
+                   (const char*)&ioTimeout, sizeof(ioTimeout));
+        setsockopt(s, SOL_SOCKET, SO_RCVTIMEO,
+                   (const char*)&ioTimeout, sizeof(ioTimeout));
+
+        ULONGLONG opStart = LatNow();
+        if (connect(s, (struct sockaddr*)&sa, sizeof(sa)) == SOCKET_ERROR) {
+            closesocket(s);
+            CountEvent(); // refused connects are still network telemetry
+            continue;
+        }
+
+        char header[256];
+        int headerLen = snprintf(header, sizeof(header),
+                                 "POST /echo HTTP/1.1\r\n"
+                                 "Host: %s\r\n"
+                                 "User-Agent: TelemetryBot/1.0\r\n"
+                                 "Content-Length: %ld\r\n"
+                                 "Connection: close\r\n"
+                                 "\r\n",
+                                 g_config.xferServer, bodyBytes);
+        if (send(s, header, headerLen, 0) == SOCKET_ERROR) {
+            closesocket(s);
+            continue;
+        }
+
+        // Stream the body from the shared pattern in 64KB slices
+        long remaining = bodyBytes;
+        while (remaining > 0 && !g_stop) {
+            int chunk = remaining > XFER_BUF_SIZE ? XFER_BUF_SIZE
+                                                  : (int)remaining;
+            int sent = send(s, g_xferPayload, chunk, 0);
+            if (sent == SOCKET_ERROR) {
+                break;
+            }
+            remaining -= sent;
+        }
+
+        // Full drain: read until the server closes, through a pooled
+        // block. A recv timeout means the server is holding the socket
+        // open; give up on the echo and count the cycle as done.
+        int bufIdx;
+        char* buf = XferAcquireBuf(&bufIdx);
+        long drained = 0;
+        if (buf != NULL) {
+            while (!g_stop) {
+                int received = recv(s, buf, XFER_BUF_SIZE, 0);
+                if (received <= 0) {
+                    break;
+                }
+                drained += received;
+            }
+        }
+        XferReleaseBuf(bufIdx);
+        closesocket(s);
+
+        LatRecord(LAT_NETWORK, opStart);
+        CountEvent();
+        TgLog("  [+] Transfer: %d KB out, %ld KB echoed back\n",
+              sizeKb, drained / 1024);
+    }
+}
+
+// Monotonic suffix so concurrent workers never fight over the same path
+volatile LONG g_fileSeq = 0;
+
+// ---------------------------------------------------------------------------
+// SIMD payload generator
+//
+// Constant payload bytes made every churn file hash identical, so the
+// sensor's hashing and content-inspection stages saw trivially cacheable
+// input. PayloadFill() regenerates a buffer with seeded pseudo-random
+// content using SSE2 16-byte stores (non-temporal when the buffer is
+// aligned, so a few hundred MB doesn't evict the working set through
+// the cache) - cheap enough to reseed per pass even at dropper sizes.
+// The entropy knob sets what fraction of 16-byte blocks are random vs
+// constant filler, approximating packed vs padded samples.
+// ---------------------------------------------------------------------------
+
+void PayloadFill(char* buf, size_t bytes, ULONGLONG seed, int entropyPct) {
+    ULONGLONG state = seed;
+    __m128i filler = _mm_set1_epi8('A');
+    int aligned = ((UINT_PTR)buf & 15) == 0;
+    size_t blocks = bytes / 16;
+    int acc = 0;
+
+    if (entropyPct < 0) entropyPct = 0;
+    if (entropyPct > 100) entropyPct = 100;
+
+    for (size_t b = 0; b < blocks; b++) {
+        __m128i v;
+        acc += entropyPct;
+        if (acc >= 100) {
+            acc -= 100;
+            v = _mm_set_epi64x((LONGLONG)SplitMix64(&state),
+                               (LONGLONG)SplitMix64(&state));
+        } else {
+            v = filler;
+        }
+        if (aligned) {
+            _mm_stream_si128((__m128i*)(buf + b * 16), v);
+        } else {
+            _mm_storeu_si128((__m128i*)(buf + b * 16), v);
+        }
+    }
+    if (aligned) {
+        _mm_sfence();
+    }
+
+    // Scalar tail for non-multiple-of-16 sizes
+    for (size_t i = blocks * 16; i < bytes; i++) {
+        buf[i] = (char)SplitMix64(&state);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Overlapped file churn engine
+//
+// The original CreateFiles() wrote three small files synchronously and
+// stopped. To stress the file-telemetry minifilter at real volume, the
+// churn engine drives create/write/delete cycles through overlapped
+// writes on an I/O completion port, keeping a window of files in flight
+// across a fan-out of temp subdirectories. Payload bytes are formatted
+// once at init so the hot loop never touches snprintf.
+// ---------------------------------------------------------------------------
+
+#define FILE_MAX_DIRS 16
+#define FILE_INFLIGHT 16
+
+typedef struct FileOp {
+    OVERLAPPED ov;       // must stay first: completions hand back &ov
+    HANDLE h;
+    char path[MAX_PATH];
+    int active;
+    ULONGLONG writeStart; // QPC when the overlapped write was queued
+} FileOp;
+
+char g_fileDirs[FILE_MAX_DIRS][MAX_PATH];
+int g_fileDirCount = 0;
+size_t g_filePayloadSize = 0;
+
+// Each worker writes from its own payload buffer: a shared one would
+// be rewritten by worker B's per-pass reseed while worker A's queued
+// overlapped writes are still reading it
+TG_THREAD_LOCAL char* t_filePayload = NULL;
+
+// Create the churn directory tree under %TEMP% and size the payload.
+// Called once from main(); the buffers themselves are allocated by
+// each worker on first use.
+void InitFileEngine(int dirs) {
+    char tempPath[MAX_PATH];
+
+    if (dirs < 1) dirs = 1;
+    if (dirs > FILE_MAX_DIRS) dirs = FILE_MAX_DIRS;
+
+    GetTempPathA(MAX_PATH, tempPath);
+    for (int i = 0; i < dirs; i++) {
+        snprintf(g_fileDirs[g_fileDirCount], MAX_PATH,
+                 "%s\\telemetry_churn_%02d", tempPath, i);
+        if (CreateDirectoryA(g_fileDirs[g_fileDirCount], NULL) ||
+            GetLastError() == ERROR_ALREADY_EXISTS) {
+            g_fileDirCount++;
+        }
+    }
+
+    if (g_config.payloadKb < 1) g_config.payloadKb = 1;
+    g_filePayloadSize = (size_t)g_config.payloadKb * 1024;
+}
+
+void CloseFileEngine() {
+    for (int i = 0; i < g_fileDirCount; i++) {
+        RemoveDirectoryA(g_fileDirs[i]); // only succeeds once churn is drained
+    }
+    g_fileDirCount = 0;
+}
+
+// Run `ops` full create/write/delete cycles with up to FILE_INFLIGHT
+// overlapped writes outstanding on a completion port.
+void RunFileEngine(int ops) {
+    FileOp window[FILE_INFLIGHT];
+    HANDLE iocp;
+    int started = 0, completed = 0, failed = 0;
+
+    if (g_fileDirCount == 0 || g_filePayloadSize == 0 || ops <= 0) {
+        return;
+    }
+    if (t_filePayload == NULL) {
+        t_filePayload = (char*)malloc(g_filePayloadSize);
+        if (t_filePayload == NULL) {
+            return;
+        }
+    }
+
+    // Reseed once per pass, not per file: every pass's files hash
+    // differently, and this thread's in-flight overlapped writes all
+    // read a stable buffer. Reseeding per file would race the writes
+    // still queued.
+    PayloadFill(t_filePayload, g_filePayloadSize,
+                g_rngSeed ^ (ULONGLONG)(ULONG)g_fileSeq,
+                g_config.payloadEntropy);
+
+    iocp = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+    if (iocp == NULL) {
+        TgLog("  [-] File engine: completion port creation failed (%lu)\n",
+               GetLastError());
+        return;
+    }
+
+    memset(window, 0, sizeof(window));
+
+    while (completed + failed < ops && !g_stop) {
+        // Keep the in-flight window full
+        for (int slot = 0; slot < FILE_INFLIGHT && started < ops; slot++) {
+            FileOp* op = &window[slot];
+            if (op->active) {
+                continue;
+            }
+
+            RateWaitToken();
+            LONG seq = InterlockedIncrement(&g_fileSeq);
+            snprintf(op->path, MAX_PATH, "%s\\churn_%ld.bin",
+                     g_fileDirs[seq % g_fileDirCount], seq);
+
+            ULONGLONG createStart = LatNow();
+            op->h = CreateFileA(op->path, GENERIC_WRITE, 0, NULL,
+                                CREATE_ALWAYS,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
+                                NULL);
+            if (op->h == INVALID_HANDLE_VALUE) {
+                failed++;
+                started++;
+                CountEvent(); // the create attempt is still telemetry
+                continue;
+            }
+            LatRecord(LAT_FILE, createStart);
+            CountEvent(); // file created
+
+            CreateIoCompletionPort(op->h, iocp, (ULONG_PTR)slot, 0);
+            memset(&op->ov, 0, sizeof(op->ov));
+            op->writeStart = LatNow();
+            if (!WriteFile(op->h, t_filePayload, (DWORD)g_filePayloadSize,
+                           NULL, &op->ov) &&
+                GetLastError() != ERROR_IO_PENDING) {
+                CloseHandle(op->h);
+                DeleteFileA(op->path);
+                failed++;
+                started++;
+                continue;
+            }
+            op->active = 1;
+            started++;
+        }
+
+        if (started >= ops && completed + failed >= started) {
+            break;
+        }
+
+        DWORD bytes;
+        ULONG_PTR key;
+        LPOVERLAPPED pov;
+        if (GetQueuedCompletionStatus(iocp, &bytes, &key, &pov, 100)) {
+            FileOp* op = &window[key];
+            LatRecord(LAT_FILE, op->writeStart);
+            CountEvent(); // write completed
+            CloseHandle(op->h);
+            DeleteFileA(op->path);
+            CountEvent(); // delete
+            op->active = 0;
+            completed++;
+        } else if (pov != NULL) {
+            // Write failed after being queued
+            FileOp* op = &window[key];
+            CloseHandle(op->h);
+            DeleteFileA(op->path);
+            op->active = 0;
+            failed++;
+        }
+    }
+
+    // Drain anything still pending before tearing the port down
+    for (int slot = 0; slot < FILE_INFLIGHT; slot++) {
+        if (window[slot].active) {
+            CancelIo(window[slot].h);
+            CloseHandle(window[slot].h);
+            DeleteFileA(window[slot].path);
+        }
+    }
+    CloseHandle(iocp);
+
+    TgLog("  [+] File churn: %d create/write/delete cycles, %d failed (%d dirs)\n",
+           completed, failed, g_fileDirCount);
+}
+
+void CreateFiles() {
+    char tempPath[MAX_PATH];
+    char filePath[MAX_PATH];
+    LONG seq = InterlockedIncrement(&g_fileSeq);
+
+    GetTempPathA(MAX_PATH, tempPath);
+
+    // Tagged runs swap the per-run file counter for the global tag so
+    // file-path telemetry joins against the sequence table
+    LONG tag = SeqClaim();
+    if (tag) seq = tag;
+
+    // Create a suspicious config file
+    RateWaitToken();
+    snprintf(filePath, MAX_PATH, "%s\\telemetry_config_%ld.dat", tempPath, seq);
+    HANDLE hFile = CreateFileA(filePath, GENERIC_WRITE, 0, NULL, 
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    
+    if (hFile != INVALID_HANDLE_VALUE) {
+        const char* configData = "C2_SERVER=example.com\nBEACON_INTERVAL=60\nENCRYPTION_KEY=ABC123\n";
+        DWORD bytesWritten;
+        WriteFile(hFile, configData, (DWORD)strlen(configData), &bytesWritten, NULL);
+        CloseHandle(hFile);
+        SeqStamp(tag);
+        CountEvent();
+        TgLog("  [+] Created config file: %s\n", filePath);
+        CleanupEnqueue(filePath);
+    }
+
+    // Create a log file
+    RateWaitToken();
+    snprintf(filePath, MAX_PATH, "%s\\telemetry_log_%ld.txt", tempPath, seq);
+    hFile = CreateFileA(filePath, GENERIC_WRITE, 0, NULL, 
+                       CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    
+    if (hFile != INVALID_HANDLE_VALUE) {
+        char logData[256];
+        snprintf(logData, sizeof(logData), 
+                 "[%lu] Telemetry test started\n[%lu] System check complete\n", 
+                 (unsigned long)time(NULL), (unsigned long)time(NULL) + 1);
+        DWORD bytesWritten;
+        WriteFile(hFile, logData, (DWORD)strlen(logData), &bytesWritten, NULL);
+        CloseHandle(hFile);
+        CountEvent();
+        TgLog("  [+] Created log file: %s\n", filePath);
+        CleanupEnqueue(filePath);
+    }
+
+    // Create a hidden file
+    RateWaitToken();
+    snprintf(filePath, MAX_PATH, "%s\\.telemetry_cache_%ld", tempPath, seq);
+    hFile = CreateFileA(filePath, GENERIC_WRITE, 0, NULL, 
+                       CREATE_ALWAYS, FILE_ATTRIBUTE_HIDDEN, NULL);
+    
+    if (hFile != INVALID_HANDLE_VALUE) {
+        const char* cacheData = "CACHED_DATA_12345";
+        DWORD bytesWritten;
+        WriteFile(hFile, cacheData, (DWORD)strlen(cacheData), &bytesWritten, NULL);
+        CloseHandle(hFile);
+        CountEvent();
+        TgLog("  [+] Created hidden file: %s\n", filePath);
+        CleanupEnqueue(filePath);
+    }
+
+    // Bulk overlapped churn on top of the fixed demo files
+    RunFileEngine(g_config.fileOps);
+}
+
+// ---------------------------------------------------------------------------
+// DNS query engine
+//
+// Replaces the serial gethostbyname() loop (which capped the generator at
+// ~3 queries/sec) with raw UDP A-record queries built in-process and sent
+// over a small set of non-blocking sockets, keeping many lookups in flight
+// at once. --dga switches the fixed domain list to generated random
+// domains so the agent's DNS path sees DGA-style load.
+// ---------------------------------------------------------------------------
+
+#define DNS_MAX_INFLIGHT 256
+#define DNS_SOCKET_SET 4
+#define DNS_TIMEOUT_MS 1000
+
+const char* g_dnsDomains[] = {
+    "malware-traffic-analysis.net",
+    "example.com",
+    "google.com",
+    "github.com",
+    "suspicious-domain-test.com"
+};
+int g_numDnsDomains = sizeof(g_dnsDomains) / sizeof(g_dnsDomains[0]);
+
+const char* g_dgaTlds[] = { "com", "net", "info", "biz", "top" };
+
+typedef struct DnsQuery {
+    int active;
+    USHORT id;
+    ULONGLONG sentTick;
+    ULONGLONG sentQpc;
+} DnsQuery;
+
+// Fill name with a DGA-style random label + TLD ("kqzxwvut3f9a.top")
+static void DnsMakeDgaDomain(char* name, size_t size) {
+    int labelLen = 8 + (int)TgRand(8);
+    int pos = 0;
+
+    for (int i = 0; i < labelLen && pos < (int)size - 8; i++) {
+        name[pos++] = "abcdefghijklmnopqrstuvwxyz0123456789"[TgRand(36)];
+    }
+    name[pos++] = '.';
+    const char* tld = g_dgaTlds[TgRand(sizeof(g_dgaTlds) / sizeof(g_dgaTlds[0]))];
+    while (*tld && pos < (int)size - 1) {
+        name[pos++] = *tld++;
+    }
+    name[pos] = '\0';
+}
+
+// Serialize one A-record query. Returns the packet length, or 0 if the
+// domain doesn't fit.
+static int DnsEncodeQuery(unsigned char* packet, int size, USHORT id,
+                          const char* domain) {
+    int pos = 0;
+
+    // 12-byte header + (strlen + 2) QNAME + 4 bytes QTYPE/QCLASS
+    if (size < 18 + (int)strlen(domain)) {
+        return 0;
+    }
+
+    // Header: id, RD flag set, one question
+    packet[pos++] = (unsigned char)(id >> 8);
+    packet[pos++] = (unsigned char)(id & 0xFF);
+    packet[pos++] = 0x01; // RD
+    packet[pos++] = 0x00;
+    packet[pos++] = 0x00; packet[pos++] = 0x01; // QDCOUNT = 1
+    packet[pos++] = 0x00; packet[pos++] = 0x00; // ANCOUNT
+    packet[pos++] = 0x00; packet[pos++] = 0x00; // NSCOUNT
+    packet[pos++] = 0x00; packet[pos++] = 0x00; // ARCOUNT
+
+    // QNAME: dotted name as length-prefixed labels
+    const char* label = domain;
+    while (*label) {
+        const char* dot = strchr(label, '.');
+        int len = dot ? (int)(dot - label) : (int)strlen(label);
+        if (len == 0 || len > 63) {
+            return 0;
+        }
+        packet[pos++] = (unsigned char)len;
+        memcpy(packet + pos, label, len);
+        pos += len;
+        label += len;
+        if (*label == '.') label++;
+    }
+    packet[pos++] = 0x00;
+
+    packet[pos++] = 0x00; packet[pos++] = 0x01; // QTYPE = A
+    packet[pos++] = 0x00; packet[pos++] = 0x01; // QCLASS = IN
+
+    return pos;
+}
+
+// Keep up to maxInflight queries outstanding across a small socket set
+// until totalQueries have completed or timed out.
+// ---------------------------------------------------------------------------
+// DNS fast path
+//
+// Even with raw packets, the flood loop pays name selection plus
+// DnsEncodeQuery per query. The fast path serializes a ring of query
+// packets once at init - names drawn from the same source the slow
+// path would use - and the send loop just patches the 2-byte
+// transaction ID and hands the buffer to sendto, which is what it
+// takes to push tens of thousands of queries/sec from one thread
+// without the generator going CPU-bound. Init also sends each ring
+// entry once and discards the answers, so the upstream resolver's
+// cache is warm before the flood starts timing anything.
+// ---------------------------------------------------------------------------
+
+#define DNS_RING 256
+
+typedef struct DnsRingPacket {
+    int len;
+    unsigned char data[512];
+} DnsRingPacket;
+
+DnsRingPacket* g_dnsRing = NULL;
+int g_dnsRingCount = 0;
+
+// Workers patch transaction IDs in place, so each thread floods from
+// its own copy of the ring; sharing g_dnsRing would let one worker's
+// ID patch land between another's patch and sendto
+TG_THREAD_LOCAL DnsRingPacket* t_dnsRing = NULL;
+
+int InitDnsFastPath() {
+    g_dnsRing = (DnsRingPacket*)malloc(DNS_RING * sizeof(DnsRingPacket));
+    if (g_dnsRing == NULL) {
+        return 0;
+    }
+
+    // Serialize the ring from the same name source the slow path uses
+    g_dnsRingCount = 0;
+    for (int i = 0; i < DNS_RING; i++) {
+        char dgaName[64];
+        const char* domain;
+
+        if (g_config.dnsDga) {
+            DnsMakeDgaDomain(dgaName, sizeof(dgaName));
+            domain = dgaName;
+        } else if (g_targetCount > 0) {
+            domain = TargetName((ULONG)TgRand(g_targetCount));
+        } else {
+            domain = g_dnsDomains[i % g_numDnsDomains];
+        }
+
+        DnsRingPacket* p = &g_dnsRing[g_dnsRingCount];
+        p->len = DnsEncodeQuery(p->data, sizeof(p->data), (USHORT)i, domain);
+        if (p->len > 0) {
+            g_dnsRingCount++;
+        }
+    }
+    if (g_dnsRingCount == 0) {
+        free(g_dnsRing);
+        g_dnsRing = NULL;
+        return 0;
+    }
+
+    // Warm pass: one shot of every ring entry, answers discarded. The
+    // upstream resolver caches the records; the flood then measures the
+    // agent, not recursive lookups.
+    struct sockaddr_in resolver;
+    memset(&resolver, 0, sizeof(resolver));
+    resolver.sin_family = AF_INET;
+    resolver.sin_port = htons(53);
+    resolver.sin_addr.s_addr = inet_addr(g_config.dnsServer);
+    if (resolver.sin_addr.s_addr != INADDR_NONE) {
+        SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s != INVALID_SOCKET) {
+            u_long nonBlocking = 1;
+            ioctlsocket(s, FIONBIO, &nonBlocking);
+            for (int i = 0; i < g_dnsRingCount; i++) {
+                sendto(s, (char*)g_dnsRing[i].data, g_dnsRing[i].len, 0,
+                       (struct sockaddr*)&resolver, sizeof(resolver));
+            }
+            Sleep(100); // let the recursive lookups land upstream
+            closesocket(s);
+        }
+    }
+
+    printf("[*] DNS fast path: %d pre-serialized packets, upstream warmed\n",
+           g_dnsRingCount);
+    return 1;
+}
+
+void RunDnsEngine(int totalQueries, int maxInflight) {
+    SOCKET sockets[DNS_SOCKET_SET];
+    DnsQuery inflight[DNS_MAX_INFLIGHT];
+    struct sockaddr_in resolver;
+    int completed = 0, failed = 0, sent = 0, numInflight = 0;
+    USHORT nextId = (USHORT)TgRand(0x10000);
+
+    if (totalQueries <= 0) {
+        return;
+    }
+    if (maxInflight < 1) maxInflight = 1;
+    if (maxInflight > DNS_MAX_INFLIGHT) maxInflight = DNS_MAX_INFLIGHT;
+
+    memset(&resolver, 0, sizeof(resolver));
+    resolver.sin_family = AF_INET;
+    resolver.sin_port = htons(53);
+    resolver.sin_addr.s_addr = inet_addr(g_config.dnsServer);
+    if (resolver.sin_addr.s_addr == INADDR_NONE) {
+        TgLog("  [-] Bad DNS server address: %s\n", g_config.dnsServer);
+        return;
+    }
+
+    for (int i = 0; i < DNS_SOCKET_SET; i++) {
+        sockets[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sockets[i] == INVALID_SOCKET) {
+            for (int j = 0; j < i; j++) closesocket(sockets[j]);
+            TgLog("  [-] DNS engine: socket() failed (%d)\n", WSAGetLastError());
+            return;
+        }
+        u_long nonBlocking = 1;
+        ioctlsocket(sockets[i], FIONBIO, &nonBlocking);
+    }
+
+    memset(inflight, 0, sizeof(inflight));
+
+    if (g_config.dnsFast && g_dnsRing != NULL && t_dnsRing == NULL) {
+        t_dnsRing = (DnsRingPacket*)malloc(g_dnsRingCount * sizeof(DnsRingPacket));
+        if (t_dnsRing != NULL) {
+            memcpy(t_dnsRing, g_dnsRing, g_dnsRingCount * sizeof(DnsRingPacket));
+        }
+        // On failure t_dnsRing stays NULL and this worker encodes per query
+    }
+
+    while (completed + failed < totalQueries && !g_stop) {
+        // Top up the in-flight window
+        while (numInflight < maxInflight && sent < totalQueries) {
+            unsigned char packet[512];
+            char dgaName[64];
+            const char* domain;
+            unsigned char* wire = packet;
+            int packetLen;
+            LONG tag = 0;
+
+            RateWaitToken();
+            USHORT id = nextId++;
+
+            if (g_config.dnsFast && t_dnsRing != NULL && !g_config.seqTable) {
+                // Flood path: reuse a pre-serialized packet, patch only
+                // the transaction ID. (Tagging needs per-query names,
+                // so --seq-table runs take the encode path below.)
+                DnsRingPacket* p = &t_dnsRing[sent % g_dnsRingCount];
+                p->data[0] = (unsigned char)(id >> 8);
+                p->data[1] = (unsigned char)(id & 0xFF);
+                wire = p->data;
+                packetLen = p->len;
+            } else {
+                tag = SeqClaim();
+                if (tag) {
+                    // Tagged label, joinable from the backend's DNS records
+                    snprintf(dgaName, sizeof(dgaName),
+                             "sq-%08lx.telemetry.test", tag);
+                    domain = dgaName;
+                } else if (g_config.dnsDga) {
+                    DnsMakeDgaDomain(dgaName, sizeof(dgaName));
+                    domain = dgaName;
+                } else if (g_targetCount > 0) {
+                    domain = TargetName((ULONG)TgRand(g_targetCount));
+                } else {
+                    domain = g_dnsDomains[sent % g_numDnsDomains];
+                }
+
+                packetLen = DnsEncodeQuery(packet, sizeof(packet), id, domain);
+                if (packetLen == 0) {
+                    failed++;
+                    sent++;
+                    continue;
+                }
+            }
+
+            SOCKET s = sockets[sent % DNS_SOCKET_SET];
+            if (sendto(s, (char*)wire, packetLen, 0,
+                       (struct sockaddr*)&resolver, sizeof(resolver)) == SOCKET_ERROR) {
+                failed++;
+                sent++;
+                CountEvent(); // the attempt still hits the network stack
+                continue;
+            }
+            SeqStamp(tag);
+
+            // Track it in the first free slot
+            for (int slot = 0; slot < maxInflight; slot++) {
+                if (!inflight[slot].active) {
+                    inflight[slot].active = 1;
+                    inflight[slot].id = id;
+                    inflight[slot].sentTick = GetTickCount64();
+                    inflight[slot].sentQpc = LatNow();
+                    numInflight++;
+                    break;
+                }
+            }
+            sent++;
+        }
+
+        if (numInflight == 0) {
+            break; // nothing outstanding and nothing left to send
+        }
+
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        SOCKET maxSocket = 0;
+        for (int i = 0; i < DNS_SOCKET_SET; i++) {
+            FD_SET(sockets[i], &readSet);
+            if (sockets[i] > maxSocket) maxSocket = sockets[i];
+        }
+
+        struct timeval tv = { 0, 50 * 1000 }; // 50 ms poll
+        int ready = select((int)maxSocket + 1, &readSet, NULL, NULL, &tv);
+
+        if (ready > 0) {
+            for (int i = 0; i < DNS_SOCKET_SET; i++) {
+                if (!FD_ISSET(sockets[i], &readSet)) {
+                    continue;
+                }
+                // Drain everything queued on this socket
+                for (;;) {
+                    unsigned char response[512];
+                    int len = recvfrom(sockets[i], (char*)response,
+                                       sizeof(response), 0, NULL, NULL);
+                    if (len < 2) {
+                        break;
+                    }
+                    USHORT id = (USHORT)((response[0] << 8) | response[1]);
+                    for (int slot = 0; slot < maxInflight; slot++) {
+                        if (inflight[slot].active && inflight[slot].id == id) {
+                            LatRecord(LAT_DNS, inflight[slot].sentQpc);
+                            inflight[slot].active = 0;
+                            numInflight--;
+                            completed++;
+                            CountEvent();
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Expire anything the resolver never answered (NXDOMAIN floods from
+        // --dga mode usually still answer; a dead resolver does not)
+        ULONGLONG now = GetTickCount64();
+        for (int slot = 0; slot < maxInflight; slot++) {
+            if (inflight[slot].active &&
+                now - inflight[slot].sentTick > DNS_TIMEOUT_MS) {
+                inflight[slot].active = 0;
+                numInflight--;
+                failed++;
+                CountEvent();
+            }
+        }
+    }
+
+    for (int i = 0; i < DNS_SOCKET_SET; i++) {
+        closesocket(sockets[i]);
+    }
+
+    TgLog("  [+] DNS engine: %d answered, %d lost/failed (%s)\n",
+           completed, failed, g_config.dnsDga ? "DGA mode" : "fixed list");
+}
+
+void PerformDNSLookups() {
+    RunDnsEngine(g_config.dnsQueries, g_config.dnsInflight);
+}
+
+// ---------------------------------------------------------------------------
+// Process-tree spawner
+//
+// Re-execs this binary with a --tree-node role argument to build
+// configurable depth/width process trees, feeding the backend's process
+// lineage graph. The root assigns its children to a kill-on-close job
+// object, so teardown of an entire tree - however wide - is a single
+// CloseHandle. Children created by nodes inside the job stay in the
+// job, so stragglers can never outlive the run. The command line for a
+// whole level is formatted once, not per child.
+// ---------------------------------------------------------------------------
+
+#define SPAWN_MAX_WIDTH 32
+#define SPAWN_NODE_TTL_MS 500
+
+// Spawn `width` copies of ourselves as tree nodes of the given depth.
+// When the root passes a job handle, children start suspended and are
+// assigned before they run, so no grandchild can escape the job.
+static int SpawnTreeChildren(int depth, int width, HANDLE* children, HANDLE job) {
+    char exePath[MAX_PATH];
+    char cmdLine[MAX_PATH + 64];
+    char cmdBuf[MAX_PATH + 64];
+    int spawned = 0;
+    DWORD flags = CREATE_NO_WINDOW | (job != NULL ? CREATE_SUSPENDED : 0);
+
+    if (width > SPAWN_MAX_WIDTH) width = SPAWN_MAX_WIDTH;
+
+    GetModuleFileNameA(NULL, exePath, MAX_PATH);
+    snprintf(cmdLine, sizeof(cmdLine), "\"%s\" --tree-node %d --spawn-width %d",
+             exePath, depth, width);
+
+    for (int i = 0; i < width; i++) {
+        STARTUPINFOA si;
+        PROCESS_INFORMATION pi;
+
+        memset(&si, 0, sizeof(si));
+        si.cb = sizeof(si);
+
+        // CreateProcessA may scribble on the buffer; hand it a copy
+        memcpy(cmdBuf, cmdLine, strlen(cmdLine) + 1);
+
+        if (CreateProcessA(exePath, cmdBuf, NULL, NULL, FALSE,
+                           flags, NULL, NULL, &si, &pi)) {
+            if (job != NULL) {
+                AssignProcessToJobObject(job, pi.hProcess);
+                ResumeThread(pi.hThread);
+            }
+            CloseHandle(pi.hThread);
+            children[spawned++] = pi.hProcess;
+        }
+    }
+    return spawned;
+}
+
+// Entry point for re-exec'd nodes: build the subtree, linger briefly so
+// the sensor can observe the whole tree alive at once, then exit.
+int TreeNodeMain(int depth, int width) {
+    HANDLE children[SPAWN_MAX_WIDTH];
+    int spawned = 0;
+
+    if (depth > 0) {
+        spawned = SpawnTreeChildren(depth - 1, width, children, NULL);
+    }
+
+    Sleep(SPAWN_NODE_TTL_MS);
+
+    if (spawned > 0) {
+        WaitForMultipleObjects((DWORD)spawned, children, TRUE, 10000);
+        for (int i = 0; i < spawned; i++) {
+            CloseHandle(children[i]);
+        }
+    }
+    return 0;
+}
+
+// Root side: build the tree under a kill-on-close job and tear it down
+void SpawnProcessTree(int depth, int width) {
+    HANDLE children[SPAWN_MAX_WIDTH];
+    HANDLE job;
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits;
+    int spawned;
+
+    if (width < 1) width = 1;
+    if (width > SPAWN_MAX_WIDTH) width = SPAWN_MAX_WIDTH;
+
+    job = CreateJobObjectA(NULL, NULL);
+    if (job != NULL) {
+        memset(&limits, 0, sizeof(limits));
+        limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+        SetInformationJobObject(job, JobObjectExtendedLimitInformation,
+                                &limits, sizeof(limits));
+    }
+
+    RateWaitToken();
+    spawned = SpawnTreeChildren(depth - 1, width, children, job);
+
+    for (int i = 0; i < spawned; i++) {
+        CountEvent();
+    }
+
+    if (spawned > 0) {
+        WaitForMultipleObjects((DWORD)spawned, children, TRUE, 30000);
+        for (int i = 0; i < spawned; i++) {
+            CloseHandle(children[i]);
+        }
+    }
+
+    // Closing the job kills anything in the tree that is still alive
+    if (job != NULL) {
+        CloseHandle(job);
+    }
+
+    // width^depth nodes counting every level below the root
+    double totalNodes = 0, levelNodes = 1;
+    for (int level = 0; level < depth; level++) {
+        levelNodes *= width;
+        totalNodes += levelNodes;
+    }
+    TgLog("  [+] Process tree: depth %d, width %d (~%.0f nodes), %d direct children\n",
+           depth, width, totalNodes, spawned);
+}
+
+// ---------------------------------------------------------------------------
+// Swarm mode
+//
+// One process can't saturate an 8-vCPU sandbox through the syscall-heavy
+// paths, so --swarm N re-execs N worker copies of this binary (same
+// arguments, plus an internal slot index), synchronizes their start on a
+// named event so they all begin emitting at the same instant, and
+// aggregates per-worker event counts through a shared-memory segment.
+// The parent prints one combined events/sec figure for the whole VM.
+// ---------------------------------------------------------------------------
+
+#define SWARM_MAX 64  // WaitForMultipleObjects ceiling
+
+typedef struct SwarmShm {
+    volatile LONG ready[SWARM_MAX];   // child init done, holding at barrier
+    volatile LONGLONG events[SWARM_MAX]; // final per-child event count
+} SwarmShm;
+
+SwarmShm* g_swarmShm = NULL;
+HANDLE g_swarmStartEvent = NULL;
+
+static void SwarmObjectNames(DWORD key, char* shmName, char* evtName, int cap) {
+    snprintf(shmName, cap, "Local\\TgSwarmShm_%lu", key);
+    snprintf(evtName, cap, "Local\\TgSwarmStart_%lu", key);
+}
+
+// Child side: map the parent's segment, flag our slot ready, and hold
+// until the start event fires. Called after all engine init, so barrier
+// release to first emission is near-instant.
+void SwarmChildArrive() {
+    char shmName[64], evtName[64];
+    SwarmObjectNames(g_config.swarmKey, shmName, evtName, sizeof(shmName));
+
+    HANDLE shm = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, shmName);
+    g_swarmStartEvent = OpenEventA(SYNCHRONIZE, FALSE, evtName);
+    if (shm == NULL || g_swarmStartEvent == NULL) {
+        printf("[-] Swarm worker %d: parent objects missing (Error: %lu)\n",
+               g_config.swarmWorker, GetLastError());
+        return;
+    }
+    g_swarmShm = (SwarmShm*)MapViewOfFile(shm, FILE_MAP_ALL_ACCESS, 0, 0,
+                                          sizeof(SwarmShm));
+    CloseHandle(shm);
+    if (g_swarmShm == NULL) {
+        return;
+    }
+
+    InterlockedExchange(&g_swarmShm->ready[g_config.swarmWorker], 1);
+    WaitForSingleObject(g_swarmStartEvent, 30000);
+}
+
+// Child side: publish the final counter for the parent to sum.
+void SwarmChildReport() {
+    if (g_swarmShm != NULL) {
+        InterlockedExchange64(&g_swarmShm->events[g_config.swarmWorker],
+                              g_eventsEmitted);
+    }
+}
+
+// Parent side: create the segment and barrier, re-exec the children with
+// our own arguments plus their slot index, release them together, wait,
+// and print the combined figure.
+int RunSwarmParent(int argc, char* argv[]) {
+    char shmName[64], evtName[64];
+    char exePath[MAX_PATH];
+    char cmdLine[1024];
+    HANDLE children[SWARM_MAX];
+    int count = g_config.swarm;
+    int spawned = 0;
+
+    if (count > SWARM_MAX) count = SWARM_MAX;
+
+    DWORD key = GetCurrentProcessId();
+    SwarmObjectNames(key, shmName, evtName, sizeof(shmName));
+
+    HANDLE shm = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                    0, sizeof(SwarmShm), shmName);
+    HANDLE startEvent = CreateEventA(NULL, TRUE, FALSE, evtName);
+    SwarmShm* view = shm != NULL
+        ? (SwarmShm*)MapViewOfFile(shm, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SwarmShm))
+        : NULL;
+    if (view == NULL || startEvent == NULL) {
+        printf("[-] Swarm: failed to create shared objects (Error: %lu)\n",
+               GetLastError());
+        return 1;
+    }
+    memset(view, 0, sizeof(SwarmShm));
+
+    // Children get our arguments minus --swarm, plus their slot; their
+    // own output is suppressed - the parent owns the console
+    GetModuleFileNameA(NULL, exePath, MAX_PATH);
+    int at = snprintf(cmdLine, sizeof(cmdLine), "\"%s\"", exePath);
+    for (int i = 1; i < argc && at < (int)sizeof(cmdLine) - 64; i++) {
+        if (strcmp(argv[i], "--swarm") == 0) {
+            i++; // skip the flag and its value
+            continue;
+        }
+        at += snprintf(cmdLine + at, sizeof(cmdLine) - at, " %s", argv[i]);
+    }
+
+    printf("[*] Swarm: launching %d worker processes...\n", count);
+
+    for (int i = 0; i < count; i++) {
+        char cmdBuf[1024 + 64];
+        STARTUPINFOA si;
+        PROCESS_INFORMATION pi;
+
+        memset(&si, 0, sizeof(si));
+        si.cb = sizeof(si);
+        snprintf(cmdBuf, sizeof(cmdBuf),
+                 "%s --swarm-worker %d --swarm-key %lu --quiet",
+                 cmdLine, i, key);
+
+        if (CreateProcessA(exePath, cmdBuf, NULL, NULL, FALSE,
+                           CREATE_NO_WINDOW, NULL, NULL, &si, &pi)) {
+            CloseHandle(pi.hThread);
+            children[spawned++] = pi.hProcess;
+        } else {
+            printf("[-] Swarm: failed to launch worker %d (Error: %lu)\n",
+                   i, GetLastError());
+        }
+    }
+    if (spawned == 0) {
+        return 1;
+    }
+
+    // Wait for every child to finish init and park at the barrier
+    for (int waited = 0; waited < 30000; waited += 50) {
+        int readyCount = 0;
+        for (int i = 0; i < spawned; i++) {
+            if (view->ready[i]) readyCount++;
+        }
+        if (readyCount >= spawned) break;
+        Sleep(50);
+    }
+
+    printf("[*] Swarm: %d workers ready, releasing start barrier\n", spawned);
+    ULONGLONG startTick = GetTickCount64();
+    SetEvent(startEvent);
+
+    WaitForMultipleObjects((DWORD)spawned, children, TRUE, INFINITE);
+    ULONGLONG elapsedMs = GetTickCount64() - startTick;
+    if (elapsedMs == 0) elapsedMs = 1;
+
+    LONGLONG total = 0;
+    for (int i = 0; i < spawned; i++) {
+        total += view->events[i];
+        CloseHandle(children[i]);
+    }
+
+    printf("\n[+] Swarm complete: %d workers\n", spawned);
+    printf("[*] Combined: %lld events in %.1f sec (%.1f events/sec)\n",
+           (long long)total, elapsedMs / 1000.0, total * 1000.0 / elapsedMs);
+
+    UnmapViewOfFile(view);
+    CloseHandle(shm);
+    CloseHandle(startEvent);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Fast-start cache
+//
+// A cold start pays for console allocation and five gethostbyname round
+// trips before the first event - several seconds against a slow
+// resolver, which is most of a short detonation window. Normal runs
+// save the resolved beacon addresses to a small cache file next to the
+// temp churn dirs; --fast-start reads it back with a single ReadFile
+// and skips resolution entirely. One plain run primes the cache for
+// every fast start after it.
+// ---------------------------------------------------------------------------
+
+#define FASTSTART_MAGIC 0x53465456UL  // "VTFS" little-endian
+#define FASTSTART_MAX_AGE_SEC (24 * 3600)
+
+#pragma pack(push, 1)
+typedef struct FastStartCache {
+    ULONG magic;
+    ULONG count;
+    ULONGLONG savedAt;            // time() when written; stale caches skip
+    ULONG addrs[16];              // resolved IPv4s, same order as targets
+} FastStartCache;
+#pragma pack(pop)
+
+static void FastStartPath(char* path) {
+    char tempPath[MAX_PATH];
+    GetTempPathA(MAX_PATH, tempPath);
+    snprintf(path, MAX_PATH, "%s\\telemetry_faststart.bin", tempPath);
+}
+
+// Returns 1 if the beacon targets were populated from the cache.
+int FastStartLoad() {
+    char path[MAX_PATH];
+    FastStartCache cache;
+    DWORD bytesRead = 0;
+
+    FastStartPath(path);
+    HANDLE h = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        return 0; // no cache yet: the caller resolves and primes it
+    }
+    BOOL ok = ReadFile(h, &cache, sizeof(cache), &bytesRead, NULL);
+    CloseHandle(h);
+
+    if (!ok || bytesRead != sizeof(cache) ||
+        cache.magic != FASTSTART_MAGIC ||
+        cache.count != (ULONG)g_numBeaconTargets ||
+        (ULONGLONG)time(NULL) - cache.savedAt > FASTSTART_MAX_AGE_SEC) {
+        return 0;
+    }
+
+    g_resolvedBeaconTargets = 0;
+    for (int i = 0; i < g_numBeaconTargets; i++) {
+        if (cache.addrs[i] != 0) {
+            g_beaconTargets[i].addr = cache.addrs[i];
+            g_beaconTargets[i].resolved = 1;
+            g_resolvedBeaconTargets++;
+        }
+    }
+    return g_resolvedBeaconTargets > 0;
+}
+
+void FastStartSave() {
+    char path[MAX_PATH];
+    FastStartCache cache;
+
+    if (g_numBeaconTargets > 16) {
+        return;
+    }
+    memset(&cache, 0, sizeof(cache));
+    cache.magic = FASTSTART_MAGIC;
+    cache.count = (ULONG)g_numBeaconTargets;
+    cache.savedAt = (ULONGLONG)time(NULL);
+    for (int i = 0; i < g_numBeaconTargets; i++) {
+        cache.addrs[i] = g_beaconTargets[i].resolved
+                             ? g_beaconTargets[i].addr : 0;
+    }
+
+    FastStartPath(path);
+    HANDLE h = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h != INVALID_HANDLE_VALUE) {
+        DWORD written;
+        WriteFile(h, &cache, sizeof(cache), &written, NULL);
+        CloseHandle(h);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// CPU-topology-aware worker placement
+//
+// Left to itself the scheduler piles workers onto whatever cores the
+// agent and Sysmon are using, so generator cost and sensor cost blur
+// together and per-core overhead numbers from --bench stop meaning
+// anything. --affinity enumerates physical cores with
+// GetLogicalProcessorInformationEx, builds a placement table ordered
+// one logical processor per physical core before any SMT sibling, and
+// pins each worker to its slot with SetThreadGroupAffinity.
+// --reserve-cores keeps the first N physical cores out of the table
+// entirely - that's where the sensor runs undisturbed.
+// ---------------------------------------------------------------------------
+
+#define CPU_MAX_SLOTS 64
+
+typedef struct CpuSlot {
+    WORD group;
+    ULONG_PTR mask;  // single logical processor within the group
+} CpuSlot;
+
+CpuSlot g_cpuSlots[CPU_MAX_SLOTS];
+int g_cpuSlotCount = 0;
+
+// Walk the processor-core records and lay out the table: first pass
+// takes the lowest logical processor of every core (minus the reserved
+// ones), second pass adds the SMT siblings, so workers spread across
+// real cores before doubling up.
+int InitCpuTopology() {
+    DWORD len = 0;
+    GetLogicalProcessorInformationEx(RelationProcessorCore, NULL, &len);
+    if (len == 0) {
+        return 0;
+    }
+    BYTE* buf = (BYTE*)malloc(len);
+    if (buf == NULL ||
+        !GetLogicalProcessorInformationEx(
+            RelationProcessorCore,
+            (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)buf, &len)) {
+        free(buf);
+        return 0;
+    }
+
+    g_cpuSlotCount = 0;
+    int coreIndex = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        DWORD at = 0;
+        coreIndex = 0;
+        while (at < len && g_cpuSlotCount < CPU_MAX_SLOTS) {
+            PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX info =
+                (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(buf + at);
+            at += info->Size;
+            if (info->Relationship != RelationProcessorCore) {
+                continue;
+            }
+
+            int reserved = coreIndex < g_config.reserveCores;
+            coreIndex++;
+            if (reserved) {
+                continue; // the sensor's cores stay out of the table
+            }
+
+            ULONG_PTR mask = info->Processor.GroupMask[0].Mask;
+            WORD group = info->Processor.GroupMask[0].Group;
+            int bitSeen = 0;
+            for (int bit = 0; bit < (int)(sizeof(ULONG_PTR) * 8); bit++) {
+                if (!(mask & ((ULONG_PTR)1 << bit))) {
+                    continue;
+                }
+                // Pass 0: first logical per core. Pass 1: the siblings.
+                if ((pass == 0) == (bitSeen == 0) &&
+                    g_cpuSlotCount < CPU_MAX_SLOTS) {
+                    g_cpuSlots[g_cpuSlotCount].group = group;
+                    g_cpuSlots[g_cpuSlotCount].mask = (ULONG_PTR)1 << bit;
+                    g_cpuSlotCount++;
+                }
+                bitSeen++;
+            }
+        }
+    }
+    free(buf);
+
+    if (g_cpuSlotCount == 0) {
+        return 0;
+    }
+    printf("[*] Affinity: %d placement slots (%d cores reserved for the sensor)\n",
+           g_cpuSlotCount, g_config.reserveCores);
+    return 1;
+}
+
+// Called by each worker as its first act; a table lookup and one call.
+void PinWorkerThread(int workerId) {
+    GROUP_AFFINITY ga;
+    CpuSlot* slot = &g_cpuSlots[workerId % g_cpuSlotCount];
+
+    memset(&ga, 0, sizeof(ga));
+    ga.Group = slot->group;
+    ga.Mask = slot->mask;
+    if (!SetThreadGroupAffinity(GetCurrentThread(), &ga, NULL)) {
+        // Pre-group-API systems: fall back to the flat mask call
+        SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)slot->mask);
+    }
+}
+
+void CreateTestMutex() {
+    RateWaitToken();
+    ULONGLONG opStart = LatNow();
+    HANDLE hMutex = CreateMutexA(NULL, FALSE, "Global\\TelemetryTestMutex");
+    LatRecord(LAT_MUTEX, opStart);
+    
+    if (hMutex != NULL) {
+        CountEvent();
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            TgLog("  [!] Mutex already exists - another worker got there first\n");
+        } else {
+            TgLog("  [+] Created mutex: Global\\TelemetryTestMutex\n");
+        }
+    }
+
+    // The well-known mutex is the detection artifact; the churn engine
+    // behind it is the load
+    RunObjectEngine(g_config.objOps);
+}
+
+// ---------------------------------------------------------------------------
+// Named-object churn engine
+//
+// Drives the object-namespace telemetry path (a known hot path in The
+// Eye) at volume: each op creates one named mutex, event, semaphore or
+// section, cycling through the four types. The name buffer is built
+// once per thread and only its numeric tail is patched per op, and
+// handles are closed in batches of --obj-batch rather than one
+// CloseHandle per create, so the loop cost is the object-manager work
+// itself, not ours.
+// ---------------------------------------------------------------------------
+
+#define OBJ_MAX_BATCH 256
+#define OBJ_NAME_RECYCLE 1024  // distinct name tails before reuse
+
+TG_THREAD_LOCAL HANDLE t_objBatch[OBJ_MAX_BATCH];
+TG_THREAD_LOCAL int t_objHeld = 0;
+TG_THREAD_LOCAL char t_objName[32];
+TG_THREAD_LOCAL int t_objSeq = -1; // -1: name prefix not built yet
+TG_THREAD_LOCAL int t_objTailAt = 0;
+
+void RunObjectEngine(int ops) {
+    if (t_objSeq < 0) {
+        // "Local\TgObj_NN_": one prefix per worker, patched tail after
+        t_objTailAt = sprintf(t_objName, "Local\\TgObj_%02lu_",
+                              GetCurrentThreadId() % 100);
+        t_objSeq = 0;
+    }
+
+    int batch = g_config.objBatch;
+    if (batch > OBJ_MAX_BATCH) batch = OBJ_MAX_BATCH;
+    if (batch < 1) batch = 1;
+
+    for (int i = 0; i < ops && !g_stop; i++) {
+        RateWaitToken();
+
+        LONG tag = SeqClaim();
+        if (tag) {
+            // Tagged runs put the global sequence in the object name
+            sprintf(t_objName + t_objTailAt, "%08lx", tag);
+        } else {
+            sprintf(t_objName + t_objTailAt, "%04d",
+                    t_objSeq % OBJ_NAME_RECYCLE);
+        }
+
+        HANDLE h = NULL;
+        ULONGLONG opStart = LatNow();
+        switch (t_objSeq & 3) {
+            case 0:
+                h = CreateMutexA(NULL, FALSE, t_objName);
+                break;
+            case 1:
+                h = CreateEventA(NULL, FALSE, FALSE, t_objName);
+                break;
+            case 2:
+                h = CreateSemaphoreA(NULL, 0, 1, t_objName);
+                break;
+            case 3:
+                h = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL,
+                                       PAGE_READWRITE, 0, 4096, t_objName);
+                break;
+        }
+        LatRecord(LAT_MUTEX, opStart);
+        SeqStamp(tag);
+        t_objSeq++;
+
+        if (h == NULL) {
+            continue;
+        }
+        CountEvent();
+
+        t_objBatch[t_objHeld++] = h;
+        if (t_objHeld >= batch) {
+            for (int j = 0; j < t_objHeld; j++) {
+                CloseHandle(t_objBatch[j]);
+            }
+            t_objHeld = 0;
+        }
+    }
+}
+
+// Close whatever the last partial batch still holds; called once per
+// worker on the way out.
+void ObjectEngineFlush() {
+    for (int j = 0; j < t_objHeld; j++) {
+        CloseHandle(t_objBatch[j]);
+    }
+    t_objHeld = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Module-load churn engine
+//
+// Image-load events are among the highest-volume telemetry in real
+// detonations and nothing here generated any. Each cycle is one
+// LoadLibraryExA/FreeLibrary pair over a rotation staged at init:
+// system DLLs this process doesn't link (so every load is a real map,
+// not a refcount bump) plus a handful of stub DLLs we write ourselves -
+// minimal but valid PE64 images, so the sensor also sees loads from
+// non-system paths the way dropped payloads look. The name table is
+// preallocated at init; the hot loop does no allocation and no string
+// formatting.
+// ---------------------------------------------------------------------------
+
+#define DLL_MAX_NAMES 32
+#define DLL_MAX_STUBS 8
+
+// System DLLs that nothing in this binary links against
+static const char* g_dllSystemList[] = {
+    "imagehlp.dll", "winhttp.dll", "dnsapi.dll", "cabinet.dll",
+    "msimg32.dll", "wtsapi32.dll", "version.dll", "winmm.dll"
+};
+
+char g_dllNames[DLL_MAX_NAMES][MAX_PATH];
+int g_dllNameCount = 0;
+char g_dllStubPaths[DLL_MAX_STUBS][MAX_PATH];
+int g_dllStubCount = 0;
+TG_THREAD_LOCAL unsigned int t_dllSeq = 0;
+
+// Minimal PE64 image: DOS header, one .text section holding a DllMain
+// that returns TRUE. Enough for the loader to map and call it, which is
+// all an image-load event needs.
+#pragma pack(push, 1)
+typedef struct StubFileHeader {
+    USHORT machine;
+    USHORT numberOfSections;
+    ULONG timeDateStamp;
+    ULONG pointerToSymbolTable;
+    ULONG numberOfSymbols;
+    USHORT sizeOfOptionalHeader;
+    USHORT characteristics;
+} StubFileHeader;
+
+typedef struct StubOptionalHeader64 {
+    USHORT magic;
+    BYTE majorLinkerVersion;
+    BYTE minorLinkerVersion;
+    ULONG sizeOfCode;
+    ULONG sizeOfInitializedData;
+    ULONG sizeOfUninitializedData;
+    ULONG addressOfEntryPoint;
+    ULONG baseOfCode;
+    ULONGLONG imageBase;
+    ULONG sectionAlignment;
+    ULONG fileAlignment;
+    USHORT majorOperatingSystemVersion;
+    USHORT minorOperatingSystemVersion;
+    USHORT majorImageVersion;
+    USHORT minorImageVersion;
+    USHORT majorSubsystemVersion;
+    USHORT minorSubsystemVersion;
+    ULONG win32VersionValue;
+    ULONG sizeOfImage;
+    ULONG sizeOfHeaders;
+    ULONG checkSum;
+    USHORT subsystem;
+    USHORT dllCharacteristics;
+    ULONGLONG sizeOfStackReserve;
+    ULONGLONG sizeOfStackCommit;
+    ULONGLONG sizeOfHeapReserve;
+    ULONGLONG sizeOfHeapCommit;
+    ULONG loaderFlags;
+    ULONG numberOfRvaAndSizes;
+    struct { ULONG rva; ULONG size; } dataDirectory[16];
+} StubOptionalHeader64;
+
+typedef struct StubSectionHeader {
+    char name[8];
+    ULONG virtualSize;
+    ULONG virtualAddress;
+    ULONG sizeOfRawData;
+    ULONG pointerToRawData;
+    ULONG pointerToRelocations;
+    ULONG pointerToLinenumbers;
+    USHORT numberOfRelocations;
+    USHORT numberOfLinenumbers;
+    ULONG characteristics;
+} StubSectionHeader;
+#pragma pack(pop)
+
+// Write one stub DLL image. 1KB file: headers in the first 0x200 bytes,
+// the entry stub at 0x200.
+static int DllWriteStub(const char* path) {
+    BYTE image[0x400];
+    memset(image, 0, sizeof(image));
+
+    // DOS header: just the magic and the offset to the NT headers
+    image[0] = 'M';
+    image[1] = 'Z';
+    *(ULONG*)(image + 0x3C) = 0x40;
+
+    // NT signature
+    memcpy(image + 0x40, "PE\0\0", 4);
+
+    StubFileHeader* file = (StubFileHeader*)(image + 0x44);
+    file->machine = 0x8664; // x64
+    file->numberOfSections = 1;
+    file->sizeOfOptionalHeader = sizeof(StubOptionalHeader64);
+    // EXECUTABLE_IMAGE | LARGE_ADDRESS_AWARE | DLL | RELOCS_STRIPPED
+    file->characteristics = 0x2023;
+
+    StubOptionalHeader64* opt =
+        (StubOptionalHeader64*)(image + 0x44 + sizeof(StubFileHeader));
+    opt->magic = 0x20B; // PE32+
+    opt->sizeOfCode = 0x200;
+    opt->addressOfEntryPoint = 0x1000; // DllMain stub below
+    opt->baseOfCode = 0x1000;
+    opt->imageBase = 0x180000000ULL;
+    opt->sectionAlignment = 0x1000;
+    opt->fileAlignment = 0x200;
+    opt->majorOperatingSystemVersion = 6;
+    opt->majorSubsystemVersion = 6;
+    opt->sizeOfImage = 0x2000;
+    opt->sizeOfHeaders = 0x200;
+    opt->subsystem = 2; // WINDOWS_GUI
+    opt->sizeOfStackReserve = 0x100000;
+    opt->sizeOfStackCommit = 0x1000;
+    opt->sizeOfHeapReserve = 0x100000;
+    opt->sizeOfHeapCommit = 0x1000;
+    opt->numberOfRvaAndSizes = 16;
+
+    StubSectionHeader* text = (StubSectionHeader*)((BYTE*)opt +
+                                                   sizeof(StubOptionalHeader64));
+    memcpy(text->name, ".text", 5);
+    text->virtualSize = 0x10;
+    text->virtualAddress = 0x1000;
+    text->sizeOfRawData = 0x200;
+    text->pointerToRawData = 0x200;
+    text->characteristics = 0x60000020; // CODE | EXECUTE | READ
+
+    // DllMain: mov eax, 1; ret
+    static const BYTE entry[] = { 0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3 };
+    memcpy(image + 0x200, entry, sizeof(entry));
+
+    HANDLE h = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    DWORD written;
+    BOOL ok = WriteFile(h, image, sizeof(image), &written, NULL);
+    CloseHandle(h);
+    return ok && written == sizeof(image);
+}
+
+// Stage the rotation: system DLLs first, then the generated stubs.
+void InitDllEngine(int stubs) {
+    char tempPath[MAX_PATH];
+    int systemCount = sizeof(g_dllSystemList) / sizeof(g_dllSystemList[0]);
+
+    g_dllNameCount = 0;
+    for (int i = 0; i < systemCount && g_dllNameCount < DLL_MAX_NAMES; i++) {
+        strncpy(g_dllNames[g_dllNameCount++], g_dllSystemList[i], MAX_PATH - 1);
+    }
+
+    if (stubs > DLL_MAX_STUBS) stubs = DLL_MAX_STUBS;
+    GetTempPathA(MAX_PATH, tempPath);
+    for (int i = 0; i < stubs && g_dllNameCount < DLL_MAX_NAMES; i++) {
+        char path[MAX_PATH];
+        snprintf(path, MAX_PATH, "%s\\telemetry_stub_%02d.dll", tempPath, i);
+        if (DllWriteStub(path)) {
+            strncpy(g_dllStubPaths[g_dllStubCount++], path, MAX_PATH - 1);
+            strncpy(g_dllNames[g_dllNameCount++], path, MAX_PATH - 1);
+        }
+    }
+
+    printf("[*] Module engine: %d system DLLs, %d generated stubs\n",
+           g_dllNameCount - g_dllStubCount, g_dllStubCount);
+}
+
+void CloseDllEngine() {
+    for (int i = 0; i < g_dllStubCount; i++) {
+        DeleteFileA(g_dllStubPaths[i]);
+    }
+    g_dllStubCount = 0;
+    g_dllNameCount = 0;
+}
+
+// One load/free pair per op. The immediate free means the next load of
+// the same name is a full map again - every cycle is two image events.
+void RunDllEngine(int ops) {
+    if (g_dllNameCount == 0) {
+        return;
+    }
+
+    for (int i = 0; i < ops && !g_stop; i++) {
+        RateWaitToken();
+        const char* name = g_dllNames[t_dllSeq++ % g_dllNameCount];
+
+        ULONGLONG opStart = LatNow();
+        HMODULE mod = LoadLibraryExA(name, NULL, 0);
+        if (mod != NULL) {
+            FreeLibrary(mod);
+        }
+        LatRecord(LAT_MODULE, opStart);
+        CountEvent();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Soak cleanup pipeline
+//
+// Multi-hour soak runs (--soak) must hold a flat footprint: the demo
+// files CreateFiles() writes carry an ever-growing sequence number, so
+// without cleanup a soak fills the temp directory. Workers enqueue each
+// created path into a ring; a dedicated cleanup thread consumes it and
+// deletes the files, pipelined behind generation so emission never
+// waits on deletion. The delete itself is more file telemetry for the
+// agent, which is a feature. The same thread re-deletes the fixed
+// persistence registry values every few seconds (workers rewrite them
+// every pass), so the registry footprint stays flat too.
+// ---------------------------------------------------------------------------
+
+#define CLEAN_RING 4096            // power of two
+#define CLEAN_REG_SWEEP_MS 5000
+
+typedef struct CleanSlot {
+    volatile LONG ready;
+    char path[MAX_PATH];
+} CleanSlot;
+
+CleanSlot g_cleanRing[CLEAN_RING];
+volatile LONG g_cleanHead = 0;
+volatile LONG g_cleanTail = 0;
+volatile LONG g_cleanActive = 0;
+volatile LONG g_cleanInline = 0;   // ring-full fallback deletions
+HANDLE g_cleanThread = NULL;
+
+// Hand a path to the cleanup thread. No-op outside soak mode. If the
+// ring is full the cleanup thread is behind; delete inline rather than
+// leak (bounded stall, counted).
+void CleanupEnqueue(const char* path) {
+    if (!g_cleanActive) {
+        return;
+    }
+    LONG head = g_cleanHead;
+    if (head - g_cleanTail >= CLEAN_RING) {
+        DeleteFileA(path);
+        InterlockedIncrement(&g_cleanInline);
+        return;
+    }
+    if (InterlockedCompareExchange(&g_cleanHead, head + 1, head) != head) {
+        // Another worker claimed the slot; one retry, then fall back
+        head = g_cleanHead;
+        if (head - g_cleanTail >= CLEAN_RING ||
+            InterlockedCompareExchange(&g_cleanHead, head + 1, head) != head) {
+            DeleteFileA(path);
+            InterlockedIncrement(&g_cleanInline);
+            return;
+        }
+    }
+
+    CleanSlot* slot = &g_cleanRing[head & (CLEAN_RING - 1)];
+    strncpy(slot->path, path, MAX_PATH - 1);
+    slot->path[MAX_PATH - 1] = '\0';
+    InterlockedExchange(&slot->ready, 1);
+}
+
+DWORD WINAPI CleanupThread(LPVOID param) {
+    ULONGLONG lastRegSweep = GetTickCount64();
+
+    while (g_cleanActive || g_cleanTail != g_cleanHead) {
+        if (g_cleanTail == g_cleanHead) {
+            if (!g_cleanActive) {
+                break;
+            }
+            Sleep(10);
+        } else {
+            CleanSlot* slot = &g_cleanRing[g_cleanTail & (CLEAN_RING - 1)];
+            if (!slot->ready) {
+                // Claimed but not yet written; producer is mid-copy
+                Sleep(1);
+                continue;
+            }
+            DeleteFileA(slot->path);
+            InterlockedExchange(&slot->ready, 0);
+            g_cleanTail++;
+        }
+
+        ULONGLONG now = GetTickCount64();
+        if (now - lastRegSweep >= CLEAN_REG_SWEEP_MS) {
+            lastRegSweep = now;
+            if (g_regRunOnceKey != NULL)
+                RegDeleteValueA(g_regRunOnceKey, "TelemetryTest");
+            if (g_regRunKey != NULL)
+                RegDeleteValueA(g_regRunKey, "TelemetryService");
+            if (g_regCustomKey != NULL) {
+                RegDeleteValueA(g_regCustomKey, "InstallTime");
+                RegDeleteValueA(g_regCustomKey, "Version");
+            }
+        }
+    }
+
+    (void)param;
+    return 0;
+}
+
+void CleanupStart() {
+    InterlockedExchange(&g_cleanActive, 1);
+    g_cleanThread = CreateThread(NULL, 0, CleanupThread, NULL, 0, NULL);
+    if (g_cleanThread == NULL) {
+        printf("[-] Failed to start cleanup thread (Error: %lu)\n",
+               GetLastError());
+        InterlockedExchange(&g_cleanActive, 0);
+    }
+    printf("[*] Soak mode: %d hour(s), cleanup pipeline running\n",
+           g_config.soakHours);
+}
+
+// Stop the pipeline, drain the backlog, and take one final registry
+// sweep so a finished soak leaves the machine as it found it.
+void CleanupStop() {
+    if (g_cleanThread == NULL) {
+        return;
+    }
+    InterlockedExchange(&g_cleanActive, 0);
+    WaitForSingleObject(g_cleanThread, 30000);
+    CloseHandle(g_cleanThread);
+    g_cleanThread = NULL;
+
+    if (g_regRunOnceKey != NULL)
+        RegDeleteValueA(g_regRunOnceKey, "TelemetryTest");
+    if (g_regRunKey != NULL)
+        RegDeleteValueA(g_regRunKey, "TelemetryService");
+
+    if (g_cleanInline > 0) {
+        printf("[!] Cleanup ring overflowed %ld time(s); deletions ran inline\n",
+               g_cleanInline);
+    }
 }
 
 void SleepRandom() {
-    int sleepTime = 1000 + (rand() % 2000); // 1-3 seconds
+    int sleepTime = 1000 + (int)TgRand(2000); // 1-3 seconds
     Sleep(sleepTime);
 }
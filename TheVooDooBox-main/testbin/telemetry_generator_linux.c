@@ -0,0 +1,962 @@
+/*
+ * Telemetry Generator - Linux platform binary
+ *
+ * The Windows generator load-tests the agent inside the analysis VM;
+ * nothing could load-test the Linux side of the lab (Voodoo Gateway,
+ * Remnux ingestion) with comparable numbers. This binary reuses the
+ * engine core from telemetry_core.h - the same PRNG streams, latency
+ * histogram, generator-mix flags, profile grammar and report schema -
+ * with the platform layer swapped: epoll-driven non-blocking sockets
+ * instead of select/Winsock, POSIX file churn under /tmp instead of
+ * overlapped I/O in %TEMP%, fork-based process trees instead of
+ * CreateProcess, named semaphores instead of named mutexes, and
+ * dlopen instead of LoadLibrary. A profile spec or a --report file
+ * produced here means the same thing it means on Windows, so the two
+ * sandboxes can be compared run for run.
+ *
+ * Build: make   (or: gcc -O2 -Wall -o telemetry_generator_linux
+ *                     telemetry_generator_linux.c -lpthread -ldl)
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "telemetry_core.h" // engine core shared with the Windows binary
+
+// Run configuration, filled in from the command line in main()
+typedef struct GeneratorConfig {
+    int threads;      // worker thread count (0 = one per logical CPU)
+    int durationSec;  // run time (0 = use loops)
+    int loops;        // passes per worker when no duration is set
+    int eps;          // target aggregate events/sec (0 = unpaced)
+    int beacons;      // HTTP beacons per worker pass
+    int httpPool;     // concurrent in-flight connects per worker
+    const char* httpServer;   // beacon target, host:port
+    int dnsQueries;   // DNS queries per worker pass
+    int dnsInflight;  // concurrent in-flight DNS queries per worker
+    int dnsDga;       // generate DGA-style random domains
+    const char* dnsServer;    // resolver the UDP engine sends to
+    int fileOps;      // file create/write/delete cycles per worker pass
+    int fileDirs;     // /tmp subdirectories the file churn spreads across
+    int objOps;       // named-semaphore create/close ops per worker pass
+    int dllOps;       // dlopen/dlclose cycles per worker pass
+    int spawnDepth;   // fork tree depth per pass (0 = phase disabled)
+    int spawnWidth;   // children per tree node
+    unsigned int seed;        // PRNG seed (0 = derive from wall clock)
+    int payloadKb;    // churn-file payload size
+    int quiet;        // drop all hot-path logging
+    const char* profile;      // phase profile spec (see ParseProfileSpec)
+    const char* reportPath;   // write the machine-readable run report here
+} GeneratorConfig;
+
+GeneratorConfig g_config = { 0, 0, 1, 0, 5, 4, "127.0.0.1:8080", 5, 16, 0,
+                             "127.0.0.1", 8, 4, 16, 0, 0, 2, 0, 4, 0,
+                             NULL, NULL };
+
+// Set to 1 to ask all workers to wind down
+atomic_int g_stop = 0;
+
+// Total telemetry-generating operations performed across all workers
+atomic_long g_eventsEmitted = 0;
+
+ProfilePhase g_profile[PROFILE_MAX_PHASES];
+int g_profileCount = 0;
+atomic_long g_phaseMix = MIX_ALL; // workers read this every pass
+
+unsigned long long g_rngSeed = 0;
+atomic_int g_rngStreams = 0;
+__thread unsigned long long t_rng[4];
+__thread int t_rngReady = 0;
+
+void CountEvent() {
+    atomic_fetch_add(&g_eventsEmitted, 1);
+}
+
+// xoshiro256**: one independent stream per calling thread; the step
+// itself lives in telemetry_core.h, shared with the Windows binary
+static unsigned long long TgRand64() {
+    if (!t_rngReady) {
+        // Stream index comes from registration order, not the thread id,
+        // so a fixed seed gives the same streams on every run
+        unsigned long long stream = g_rngSeed +
+            0x632BE59BD9B4E019ULL *
+                (unsigned long long)(atomic_fetch_add(&g_rngStreams, 1) + 1);
+        for (int i = 0; i < 4; i++) {
+            t_rng[i] = SplitMix64(&stream);
+        }
+        t_rngReady = 1;
+    }
+    return XoshiroNext(t_rng);
+}
+
+// Uniform value in [0, bound)
+unsigned int TgRand(unsigned int bound) {
+    return (unsigned int)(TgRand64() % bound);
+}
+
+void TgLog(const char* fmt, ...) {
+    va_list args;
+    if (g_config.quiet) {
+        return;
+    }
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+
+// ---------------------------------------------------------------------------
+// Emission-latency instrumentation
+//
+// Same histogram and percentile math as the Windows binary (see
+// telemetry_core.h); the only platform piece is the clock. CLOCK_MONOTONIC
+// already ticks in nanoseconds, so LatRecord() skips the QPC-frequency
+// conversion the Windows side needs.
+// ---------------------------------------------------------------------------
+
+atomic_long g_latHist[LAT_CLASS_COUNT][LAT_BUCKETS];
+atomic_long g_latSamples[LAT_CLASS_COUNT];
+
+unsigned long long LatNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL +
+           (unsigned long long)ts.tv_nsec;
+}
+
+// Record the elapsed time since startNs under the given class
+void LatRecord(int latClass, unsigned long long startNs) {
+    unsigned long long ns = LatNow() - startNs;
+    atomic_fetch_add(&g_latHist[latClass][LatBucketIndex(ns)], 1);
+    atomic_fetch_add(&g_latSamples[latClass], 1);
+}
+
+static unsigned long long LatPercentile(int latClass, double fraction) {
+    long total = g_latSamples[latClass];
+    long target = (long)(total * fraction);
+    long seen = 0;
+
+    for (int i = 0; i < LAT_BUCKETS; i++) {
+        seen += g_latHist[latClass][i];
+        if (seen >= target) {
+            return LatBucketValue(i);
+        }
+    }
+    return LatBucketValue(LAT_BUCKETS - 1);
+}
+
+void PrintLatencyReport() {
+    printf("\n[*] Per-operation latency (usec):\n");
+    printf("    %-10s %10s %10s %10s %10s %10s\n",
+           "class", "samples", "p50", "p90", "p99", "p999");
+    for (int latClass = 0; latClass < LAT_CLASS_COUNT; latClass++) {
+        if (g_latSamples[latClass] == 0) {
+            continue;
+        }
+        printf("    %-10s %10ld %10.1f %10.1f %10.1f %10.1f\n",
+               g_latClassNames[latClass], (long)g_latSamples[latClass],
+               LatPercentile(latClass, 0.50) / 1000.0,
+               LatPercentile(latClass, 0.90) / 1000.0,
+               LatPercentile(latClass, 0.99) / 1000.0,
+               LatPercentile(latClass, 0.999) / 1000.0);
+    }
+}
+
+// Same metric,value CSV lines as the Windows binary, so --compare over
+// there can diff a Linux report against a Windows one directly
+void WriteRunReport(const char* path, unsigned long long elapsedMs) {
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        printf("[-] Report: cannot write %s\n", path);
+        return;
+    }
+    if (elapsedMs == 0) elapsedMs = 1;
+
+    fprintf(f, "schema,%d\n", TG_REPORT_SCHEMA);
+    fprintf(f, "events,%ld\n", (long)g_eventsEmitted);
+    fprintf(f, "elapsed_ms,%llu\n", elapsedMs);
+    fprintf(f, "eps,%.1f\n", g_eventsEmitted * 1000.0 / elapsedMs);
+    fprintf(f, "log_dropped,0\n"); // no log ring here; kept for the schema
+
+    for (int latClass = 0; latClass < LAT_CLASS_COUNT; latClass++) {
+        if (g_latSamples[latClass] == 0) {
+            continue;
+        }
+        const char* name = g_latClassNames[latClass];
+        fprintf(f, "lat_%s_samples,%ld\n", name, (long)g_latSamples[latClass]);
+        fprintf(f, "lat_%s_p50_us,%.1f\n", name,
+                LatPercentile(latClass, 0.50) / 1000.0);
+        fprintf(f, "lat_%s_p90_us,%.1f\n", name,
+                LatPercentile(latClass, 0.90) / 1000.0);
+        fprintf(f, "lat_%s_p99_us,%.1f\n", name,
+                LatPercentile(latClass, 0.99) / 1000.0);
+    }
+
+    fclose(f);
+    printf("[*] Report written: %s\n", path);
+}
+
+// ---------------------------------------------------------------------------
+// Token-bucket rate limiter
+//
+// Same shape as the Windows limiter: a shared bucket all workers pull
+// from before every telemetry-generating operation, refilled from the
+// monotonic clock, retargetable while running so the phase scheduler
+// can shape the rate. Capacity is 1/20th of a second of tokens, enough
+// to ride out scheduling jitter without letting a stalled run burst.
+// ---------------------------------------------------------------------------
+
+typedef struct RateLimiter {
+    pthread_mutex_t lock;
+    double eps;
+    double tokens;
+    double capacity;
+    unsigned long long lastRefillNs;
+} RateLimiter;
+
+RateLimiter g_rate;
+atomic_int g_rateActive = 0; // pacing on (eps > 0)
+atomic_int g_ratePaused = 0; // burst-profile off period: hold all workers
+
+void RateSetEps(double eps) {
+    pthread_mutex_lock(&g_rate.lock);
+    g_rate.eps = eps;
+    g_rate.capacity = eps / 20.0;
+    if (g_rate.capacity < 1.0) g_rate.capacity = 1.0;
+    if (g_rate.tokens > g_rate.capacity) {
+        g_rate.tokens = g_rate.capacity;
+    }
+    g_rate.lastRefillNs = LatNow();
+    pthread_mutex_unlock(&g_rate.lock);
+    atomic_store(&g_rateActive, eps > 0.0 ? 1 : 0);
+}
+
+void RateInit(int eps) {
+    pthread_mutex_init(&g_rate.lock, NULL);
+    g_rate.tokens = 0;
+    RateSetEps((double)eps);
+}
+
+void RatePause(int paused) {
+    atomic_store(&g_ratePaused, paused);
+}
+
+void RateWaitToken() {
+    while (g_ratePaused && !g_stop) {
+        usleep(1000);
+    }
+    if (!g_rateActive) {
+        return;
+    }
+
+    while (!g_stop) {
+        pthread_mutex_lock(&g_rate.lock);
+        unsigned long long now = LatNow();
+        double elapsed = (now - g_rate.lastRefillNs) / 1e9;
+        g_rate.lastRefillNs = now;
+        g_rate.tokens += elapsed * g_rate.eps;
+        if (g_rate.tokens > g_rate.capacity) {
+            g_rate.tokens = g_rate.capacity;
+        }
+        if (g_rate.tokens >= 1.0) {
+            g_rate.tokens -= 1.0;
+            pthread_mutex_unlock(&g_rate.lock);
+            return;
+        }
+        double deficit = 1.0 - g_rate.tokens;
+        double eps = g_rate.eps > 0.0 ? g_rate.eps : 1.0;
+        pthread_mutex_unlock(&g_rate.lock);
+
+        useconds_t waitUs = (useconds_t)(deficit / eps * 1e6);
+        if (waitUs < 500) waitUs = 500;
+        if (waitUs > 50000) waitUs = 50000;
+        usleep(waitUs);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Phase scheduler
+//
+// Identical to the Windows scheduler: parse with the shared
+// ParseProfileSpec(), then retarget the token bucket (and the worker
+// mix mask) every PROFILE_STEP_MS while the pool runs.
+// ---------------------------------------------------------------------------
+
+void RunProfileScheduler() {
+    int prevRate = 0;
+
+    for (int i = 0; i < g_profileCount && !g_stop; i++) {
+        ProfilePhase* p = &g_profile[i];
+        TgLog("[*] Phase %d/%d: %s %ds @ %d eps\n",
+              i + 1, g_profileCount, p->name, p->durationSec, p->rate);
+
+        atomic_store(&g_phaseMix, p->mix);
+
+        int steps = p->durationSec * 1000 / PROFILE_STEP_MS;
+        for (int s = 0; s < steps && !g_stop; s++) {
+            switch (p->kind) {
+                case PHASE_RAMP:
+                    RateSetEps(prevRate +
+                               (double)(p->rate - prevRate) * (s + 1) / steps);
+                    break;
+                case PHASE_BURST: {
+                    int elapsedMs = s * PROFILE_STEP_MS;
+                    int on = (elapsedMs / BURST_HALF_PERIOD_MS) % 2 == 0;
+                    RateSetEps((double)p->rate);
+                    RatePause(!on);
+                    break;
+                }
+                case PHASE_STEADY:
+                    if (s == 0) {
+                        RateSetEps((double)p->rate);
+                    }
+                    break;
+            }
+            usleep(PROFILE_STEP_MS * 1000);
+        }
+
+        RatePause(0);
+        prevRate = p->rate;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// File churn engine: POSIX create/write/delete cycles under /tmp
+//
+// The Linux analog of the overlapped churn engine: spread across
+// --file-dirs subdirectories of /tmp, payload regenerated from the
+// shared splitmix64 so a given (seed, size) produces the same bytes
+// on both platforms. Writes are plain blocking write(2) - on a local
+// tmpfs that is the page-cache copy the Windows overlapped path also
+// ends up measuring.
+// ---------------------------------------------------------------------------
+
+__thread char* t_filePayload = NULL;
+atomic_long g_fileSeq = 0;
+
+void InitFileEngine(int dirs) {
+    char path[256];
+    for (int i = 0; i < dirs; i++) {
+        snprintf(path, sizeof(path), "/tmp/telemetry_churn_%02d", i);
+        mkdir(path, 0700);
+    }
+}
+
+void RunFileEngine(int ops) {
+    char path[256];
+    size_t payloadLen = (size_t)g_config.payloadKb * 1024;
+
+    if (t_filePayload == NULL) {
+        t_filePayload = malloc(payloadLen);
+        if (t_filePayload == NULL) {
+            return;
+        }
+        unsigned long long state = g_rngSeed ^ atomic_fetch_add(&g_fileSeq, 1);
+        for (size_t i = 0; i + 8 <= payloadLen; i += 8) {
+            unsigned long long v = SplitMix64(&state);
+            memcpy(t_filePayload + i, &v, 8);
+        }
+    }
+
+    for (int i = 0; i < ops && !g_stop; i++) {
+        long seq = atomic_fetch_add(&g_fileSeq, 1);
+        snprintf(path, sizeof(path), "/tmp/telemetry_churn_%02d/churn_%ld.bin",
+                 (int)(seq % g_config.fileDirs), seq);
+
+        RateWaitToken();
+        unsigned long long start = LatNow();
+        int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0600);
+        if (fd < 0) {
+            continue;
+        }
+        if (write(fd, t_filePayload, payloadLen) < 0) {
+            // tmpfs full during a soak: drop the file, keep churning
+        }
+        close(fd);
+        LatRecord(LAT_FILE, start);
+        CountEvent();
+
+        unlink(path);
+        CountEvent();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Async DNS engine: epoll-driven UDP with a window of in-flight queries
+//
+// Mirrors the Windows engine: serialize queries onto one non-blocking
+// UDP socket, keep --dns-inflight outstanding, and match replies back
+// to their send timestamps by transaction ID for the latency histogram.
+// The resolver defaults to localhost so a lab gateway (or a dnsmasq on
+// the Remnux box) sees the flood without any packet leaving the host.
+// ---------------------------------------------------------------------------
+
+const char* g_dnsDomains[] = {
+    "example.com", "update-server.net", "cdn-delivery.org",
+    "telemetry-endpoint.io", "data-collector.info"
+};
+
+static int DnsEncodeQuery(char* buf, int cap, unsigned short id,
+                          const char* name) {
+    int len = 0;
+    if (cap < 17) return 0;
+
+    buf[len++] = (char)(id >> 8);
+    buf[len++] = (char)(id & 0xFF);
+    buf[len++] = 0x01; buf[len++] = 0x00; // RD
+    buf[len++] = 0x00; buf[len++] = 0x01; // QDCOUNT
+    memset(buf + len, 0, 6); len += 6;    // AN/NS/AR
+
+    while (*name) {
+        const char* dot = strchr(name, '.');
+        int label = dot ? (int)(dot - name) : (int)strlen(name);
+        if (label <= 0 || label > 63 || len + label + 6 > cap) return 0;
+        buf[len++] = (char)label;
+        memcpy(buf + len, name, label);
+        len += label;
+        name += label;
+        if (*name == '.') name++;
+    }
+    buf[len++] = 0x00;
+    buf[len++] = 0x00; buf[len++] = 0x01; // QTYPE A
+    buf[len++] = 0x00; buf[len++] = 0x01; // QCLASS IN
+    return len;
+}
+
+void RunDnsEngine(int totalQueries, int maxInflight) {
+    struct sockaddr_in server;
+    char query[512];
+    char reply[512];
+    char dga[64];
+    unsigned long long sendNs[65536];
+    int sent = 0, done = 0;
+    int inflight = 0;
+
+    if (maxInflight > 4096) maxInflight = 4096;
+
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_port = htons(53);
+    if (inet_pton(AF_INET, g_config.dnsServer, &server.sin_addr) != 1) {
+        return;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        return;
+    }
+    int ep = epoll_create1(0);
+    if (ep < 0) {
+        close(fd);
+        return;
+    }
+    struct epoll_event ev = { 0 };
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+
+    memset(sendNs, 0, sizeof(sendNs));
+
+    while (done < totalQueries && !g_stop) {
+        // Top the window up
+        while (sent < totalQueries && inflight < maxInflight && !g_stop) {
+            const char* name;
+            if (g_config.dnsDga) {
+                int n = 8 + (int)TgRand(12);
+                for (int i = 0; i < n; i++) {
+                    dga[i] = 'a' + (char)TgRand(26);
+                }
+                strcpy(dga + n, ".telemetry.test");
+                name = dga;
+            } else {
+                name = g_dnsDomains[TgRand(sizeof(g_dnsDomains) /
+                                           sizeof(g_dnsDomains[0]))];
+            }
+
+            unsigned short id = (unsigned short)sent;
+            int qlen = DnsEncodeQuery(query, sizeof(query), id, name);
+            if (qlen == 0) {
+                sent++; done++;
+                continue;
+            }
+
+            RateWaitToken();
+            sendNs[id] = LatNow();
+            sendto(fd, query, qlen, 0, (struct sockaddr*)&server,
+                   sizeof(server));
+            CountEvent();
+            sent++;
+            inflight++;
+        }
+
+        int n = epoll_wait(ep, &ev, 1, 100);
+        if (n > 0) {
+            ssize_t r;
+            while ((r = recv(fd, reply, sizeof(reply), 0)) > 0) {
+                if (r >= 2) {
+                    unsigned short id = (unsigned short)(((unsigned char)reply[0] << 8) |
+                                                         (unsigned char)reply[1]);
+                    if (sendNs[id] != 0) {
+                        LatRecord(LAT_DNS, sendNs[id]);
+                        sendNs[id] = 0;
+                    }
+                }
+                done++;
+                if (inflight > 0) inflight--;
+            }
+            if (r < 0 && errno == ECONNREFUSED) {
+                // No resolver on the target: sends still count as load,
+                // drain the error and stop waiting on replies
+                done += inflight;
+                inflight = 0;
+            }
+        } else {
+            // Replies lost or resolver absent; don't wait on them forever
+            done += inflight;
+            inflight = 0;
+        }
+    }
+
+    close(ep);
+    close(fd);
+}
+
+// ---------------------------------------------------------------------------
+// Beacon engine: epoll-driven non-blocking TCP connect + HTTP GET
+//
+// The Windows engine's keep-alive pool maps to a window of --http-pool
+// concurrent non-blocking connects: epoll tells us when each connect
+// completes (that edge is the LAT_NETWORK sample), the beacon request
+// goes out, one read drains whatever the server answers, and the
+// socket closes. Defaults to localhost so the gateway under test is
+// the listener.
+// ---------------------------------------------------------------------------
+
+typedef struct BeaconSlot {
+    int fd;
+    unsigned long long startNs;
+} BeaconSlot;
+
+void RunBeaconEngine(int totalRequests, int poolSize) {
+    struct sockaddr_in server;
+    char hostBuf[128];
+    char request[256];
+    char drain[4096];
+    BeaconSlot slots[64];
+    int started = 0, done = 0, active = 0;
+
+    if (poolSize > 64) poolSize = 64;
+
+    strncpy(hostBuf, g_config.httpServer, sizeof(hostBuf) - 1);
+    hostBuf[sizeof(hostBuf) - 1] = '\0';
+    char* colon = strchr(hostBuf, ':');
+    int port = 80;
+    if (colon != NULL) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+    }
+
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_port = htons((unsigned short)port);
+    if (inet_pton(AF_INET, hostBuf, &server.sin_addr) != 1) {
+        return;
+    }
+
+    snprintf(request, sizeof(request),
+             "GET /beacon HTTP/1.1\r\nHost: %s\r\n"
+             "User-Agent: TelemetryBot/1.0\r\nConnection: close\r\n\r\n",
+             hostBuf);
+
+    int ep = epoll_create1(0);
+    if (ep < 0) {
+        return;
+    }
+    for (int i = 0; i < poolSize; i++) {
+        slots[i].fd = -1;
+    }
+
+    while (done < totalRequests && !g_stop) {
+        // Keep the connect window full
+        for (int i = 0; i < poolSize && started < totalRequests; i++) {
+            if (slots[i].fd != -1) {
+                continue;
+            }
+            int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (fd < 0) {
+                break;
+            }
+            RateWaitToken();
+            slots[i].startNs = LatNow();
+            if (connect(fd, (struct sockaddr*)&server, sizeof(server)) < 0 &&
+                errno != EINPROGRESS) {
+                close(fd);
+                CountEvent(); // refused connects are still load on the stack
+                started++;
+                done++;
+                continue;
+            }
+            struct epoll_event ev = { 0 };
+            ev.events = EPOLLOUT;
+            ev.data.u32 = (uint32_t)i;
+            epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+            slots[i].fd = fd;
+            started++;
+            active++;
+        }
+
+        if (active == 0) {
+            if (started >= totalRequests) break;
+            continue;
+        }
+
+        struct epoll_event events[64];
+        int n = epoll_wait(ep, events, poolSize, 200);
+        if (n <= 0) {
+            // Nothing completed within the window: treat the stragglers
+            // as done so a dead listener can't wedge the pass
+            for (int i = 0; i < poolSize; i++) {
+                if (slots[i].fd != -1) {
+                    epoll_ctl(ep, EPOLL_CTL_DEL, slots[i].fd, NULL);
+                    close(slots[i].fd);
+                    slots[i].fd = -1;
+                    done++;
+                    active--;
+                }
+            }
+            continue;
+        }
+
+        for (int e = 0; e < n; e++) {
+            int i = (int)events[e].data.u32;
+            int fd = slots[i].fd;
+            if (fd == -1) {
+                continue;
+            }
+
+            int err = 0;
+            socklen_t errLen = sizeof(err);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen);
+            if (err == 0) {
+                LatRecord(LAT_NETWORK, slots[i].startNs);
+                if (send(fd, request, strlen(request), MSG_NOSIGNAL) > 0) {
+                    // One drain read; the gateway's answer is not the test
+                    recv(fd, drain, sizeof(drain), MSG_DONTWAIT);
+                }
+            }
+            CountEvent();
+            epoll_ctl(ep, EPOLL_CTL_DEL, fd, NULL);
+            close(fd);
+            slots[i].fd = -1;
+            done++;
+            active--;
+        }
+    }
+
+    for (int i = 0; i < poolSize; i++) {
+        if (slots[i].fd != -1) {
+            close(slots[i].fd);
+        }
+    }
+    close(ep);
+}
+
+// ---------------------------------------------------------------------------
+// Named-object churn: POSIX named semaphores
+//
+// The closest Linux analog to the Windows named-mutex/event churn:
+// sem_open/sem_close/sem_unlink cycles under /dev/shm, which is what a
+// sensor watching the shared-memory namespace sees.
+// ---------------------------------------------------------------------------
+
+void RunObjectEngine(int ops) {
+    char name[64];
+    pid_t pid = getpid();
+
+    for (int i = 0; i < ops && !g_stop; i++) {
+        snprintf(name, sizeof(name), "/tg_obj_%d_%04x", (int)pid,
+                 (unsigned int)TgRand(0x10000));
+        RateWaitToken();
+        unsigned long long start = LatNow();
+        sem_t* sem = sem_open(name, O_CREAT, 0600, 0);
+        if (sem != SEM_FAILED) {
+            sem_close(sem);
+            sem_unlink(name);
+            LatRecord(LAT_MUTEX, start);
+        }
+        CountEvent();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Module-load churn: dlopen/dlclose cycles
+//
+// Same idea as the Windows LoadLibrary engine: rotate through system
+// libraries that are present but rarely already mapped, so each cycle
+// produces real mmap/unmap activity for the sensor.
+// ---------------------------------------------------------------------------
+
+const char* g_dllSystemList[] = {
+    "libm.so.6", "libresolv.so.2", "librt.so.1", "libcrypt.so.1"
+};
+
+void RunDllEngine(int ops) {
+    int count = (int)(sizeof(g_dllSystemList) / sizeof(g_dllSystemList[0]));
+
+    for (int i = 0; i < ops && !g_stop; i++) {
+        const char* name = g_dllSystemList[i % count];
+        RateWaitToken();
+        unsigned long long start = LatNow();
+        void* handle = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+        if (handle != NULL) {
+            dlclose(handle);
+            LatRecord(LAT_MODULE, start);
+        }
+        CountEvent();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Fork-based process trees
+//
+// CreateProcess trees become fork trees: each node forks --spawn-width
+// children, every child recurses one level shallower and exits. Short
+// lifetimes on purpose - process-start/stop event pairs are the load,
+// not the work the children do.
+// ---------------------------------------------------------------------------
+
+void SpawnProcessTree(int depth, int width) {
+    if (depth <= 0 || g_stop) {
+        return;
+    }
+
+    for (int i = 0; i < width; i++) {
+        RateWaitToken();
+        pid_t pid = fork();
+        if (pid == 0) {
+            SpawnProcessTree(depth - 1, width);
+            _exit(0);
+        }
+        if (pid > 0) {
+            CountEvent();
+            waitpid(pid, NULL, 0);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Worker pool
+// ---------------------------------------------------------------------------
+
+void* GeneratorWorker(void* param) {
+    int workerId = (int)(long)param;
+    int pass = 0;
+
+    while (!g_stop) {
+        long mix = atomic_load(&g_phaseMix);
+
+        if (mix & MIX_MUTEX)    RunObjectEngine(g_config.objOps);
+        if (mix & MIX_WEB)      RunBeaconEngine(g_config.beacons,
+                                                g_config.httpPool);
+        if (mix & MIX_FILES)    RunFileEngine(g_config.fileOps);
+        if (mix & MIX_DNS)      RunDnsEngine(g_config.dnsQueries,
+                                             g_config.dnsInflight);
+        if ((mix & MIX_MODULE) && g_config.dllOps > 0) {
+            RunDllEngine(g_config.dllOps);
+        }
+
+        // Fork trees are heavyweight; one worker drives them so the
+        // spawn rate is set by depth/width, not the thread count
+        if (workerId == 0 && g_config.spawnDepth > 0 && (mix & MIX_SPAWN)) {
+            SpawnProcessTree(g_config.spawnDepth, g_config.spawnWidth);
+        }
+
+        pass++;
+        if (g_config.durationSec == 0 && g_profileCount == 0 &&
+            pass >= g_config.loops) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+void PrintUsage(const char* exeName) {
+    printf("Usage: %s [options]\n", exeName);
+    printf("\n");
+    printf("Options:\n");
+    printf("  --threads N    worker threads (default: one per logical CPU)\n");
+    printf("  --duration S   run for S seconds instead of a fixed pass count\n");
+    printf("  --loops N      passes per worker when no duration is set (default: 1)\n");
+    printf("  --eps N        pace all workers to N aggregate events/sec\n");
+    printf("  --beacons N    HTTP beacons per worker pass (default: 5)\n");
+    printf("  --http-pool N  concurrent in-flight connects per worker (default: 4)\n");
+    printf("  --http-server H:P  beacon target (default: 127.0.0.1:8080)\n");
+    printf("  --dns-queries N  DNS queries per worker pass (default: 5)\n");
+    printf("  --dns-inflight N concurrent in-flight queries per worker (default: 16)\n");
+    printf("  --dns-server IP  resolver for the UDP DNS engine (default: 127.0.0.1)\n");
+    printf("  --dga          query DGA-style random domains instead of the fixed list\n");
+    printf("  --file-ops N   file create/write/delete cycles per worker pass (default: 8)\n");
+    printf("  --file-dirs N  /tmp subdirectories for file churn (default: 4)\n");
+    printf("  --obj-ops N    named-semaphore ops per worker pass (default: 16)\n");
+    printf("  --dll-ops N    dlopen/dlclose cycles per worker pass (default: 0)\n");
+    printf("  --spawn-depth N  fork tree depth per pass (default: 0 = off)\n");
+    printf("  --spawn-width N  children per tree node (default: 2)\n");
+    printf("  --payload-kb N   churn-file payload size in KB (default: 4)\n");
+    printf("  --seed N       deterministic PRNG seed for reproducible runs\n");
+    printf("  --quiet        drop per-event output entirely (load runs)\n");
+    printf("  --profile SPEC shaped load: comma list of KIND:SECS:RATE[:MIX] phases,\n");
+    printf("                 same grammar as the Windows binary\n");
+    printf("  --report F     write a machine-readable run report (CSV) at exit\n");
+    printf("  --help         show this help\n");
+    printf("\n");
+    printf("The registry class has no Linux analog; its mix letter and report\n");
+    printf("lines are simply absent here.\n");
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            g_config.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            g_config.durationSec = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            g_config.loops = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--eps") == 0 && i + 1 < argc) {
+            g_config.eps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--beacons") == 0 && i + 1 < argc) {
+            g_config.beacons = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--http-pool") == 0 && i + 1 < argc) {
+            g_config.httpPool = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--http-server") == 0 && i + 1 < argc) {
+            g_config.httpServer = argv[++i];
+        } else if (strcmp(argv[i], "--dns-queries") == 0 && i + 1 < argc) {
+            g_config.dnsQueries = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dns-inflight") == 0 && i + 1 < argc) {
+            g_config.dnsInflight = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dns-server") == 0 && i + 1 < argc) {
+            g_config.dnsServer = argv[++i];
+        } else if (strcmp(argv[i], "--dga") == 0) {
+            g_config.dnsDga = 1;
+        } else if (strcmp(argv[i], "--file-ops") == 0 && i + 1 < argc) {
+            g_config.fileOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--file-dirs") == 0 && i + 1 < argc) {
+            g_config.fileDirs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--obj-ops") == 0 && i + 1 < argc) {
+            g_config.objOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dll-ops") == 0 && i + 1 < argc) {
+            g_config.dllOps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--spawn-depth") == 0 && i + 1 < argc) {
+            g_config.spawnDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--spawn-width") == 0 && i + 1 < argc) {
+            g_config.spawnWidth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--payload-kb") == 0 && i + 1 < argc) {
+            g_config.payloadKb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            g_config.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            g_config.quiet = 1;
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            g_config.profile = argv[++i];
+        } else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            g_config.reportPath = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0) {
+            PrintUsage(argv[0]);
+            return 0;
+        } else {
+            printf("[-] Unknown option: %s\n", argv[i]);
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (g_config.threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        g_config.threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (g_config.threads > 256) g_config.threads = 256;
+    if (g_config.fileDirs <= 0) g_config.fileDirs = 1;
+    if (g_config.payloadKb <= 0) g_config.payloadKb = 1;
+
+    g_rngSeed = g_config.seed != 0 ? g_config.seed
+                                   : (unsigned long long)time(NULL);
+
+    if (g_config.profile != NULL) {
+        g_profileCount = ParseProfileSpec(g_config.profile, g_profile,
+                                          PROFILE_MAX_PHASES);
+        if (g_profileCount == 0) {
+            return 1;
+        }
+        // The scheduler owns the clock; workers loop until told to stop
+        g_config.durationSec = 0;
+        atomic_store(&g_phaseMix, g_profile[0].mix);
+    }
+
+    if (!g_config.quiet) {
+        printf("==========================================\n");
+        printf("  Telemetry Generator (linux)\n");
+        printf("  %d workers\n", g_config.threads);
+        printf("==========================================\n\n");
+    }
+
+    RateInit(g_config.eps);
+    InitFileEngine(g_config.fileDirs);
+
+    unsigned long long startNs = LatNow();
+
+    pthread_t workers[256];
+    for (int i = 0; i < g_config.threads; i++) {
+        if (pthread_create(&workers[i], NULL, GeneratorWorker,
+                           (void*)(long)i) != 0) {
+            printf("[-] Failed to create worker %d\n", i);
+            g_config.threads = i;
+            break;
+        }
+    }
+    if (g_config.threads == 0) {
+        printf("[-] No workers started, aborting\n");
+        return 1;
+    }
+
+    if (g_profileCount > 0) {
+        RunProfileScheduler();
+        atomic_store(&g_stop, 1);
+    } else if (g_config.durationSec > 0) {
+        sleep((unsigned int)g_config.durationSec);
+        atomic_store(&g_stop, 1);
+    }
+    for (int i = 0; i < g_config.threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    unsigned long long elapsedMs = (LatNow() - startNs) / 1000000ULL;
+    if (elapsedMs == 0) elapsedMs = 1;
+
+    printf("\n[+] Telemetry generation complete!\n");
+    PrintLatencyReport();
+    printf("[*] Events emitted: %ld in %.1f sec (%.1f events/sec)\n",
+           (long)g_eventsEmitted, elapsedMs / 1000.0,
+           g_eventsEmitted * 1000.0 / elapsedMs);
+
+    if (g_config.reportPath != NULL) {
+        WriteRunReport(g_config.reportPath, elapsedMs);
+    }
+
+    return 0;
+}